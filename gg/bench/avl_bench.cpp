@@ -0,0 +1,98 @@
+/**
+ * avl_bench.cpp - Branch tree benchmark (make bench)
+ *
+ * Creates 100k branches with names in sorted order, the worst case for an
+ * unbalanced tree, then deletes them all. Reports tree height and lookup
+ * latency as the tree grows, so O(log n) behaviour is visible: each tenfold
+ * increase in branches should add a roughly constant amount to both.
+ */
+
+#include "../include/avl.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsed_ns(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static std::string branch_name(size_t i) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "release/%06zu", i);
+    return name;
+}
+
+// Average time of random successful lookups among the first count branches
+static double lookup_ns(const AVLTree& tree, size_t count, std::mt19937& rng) {
+    const size_t LOOKUPS = 200000;
+    std::vector<std::string> names;
+    names.reserve(LOOKUPS);
+    for (size_t i = 0; i < LOOKUPS; ++i) {
+        names.push_back(branch_name(rng() % count));
+    }
+
+    size_t found = 0;
+    Clock::time_point start = Clock::now();
+    for (const auto& name : names) {
+        found += tree.find(name) != nullptr;
+    }
+    double total = elapsed_ns(start);
+    if (found != LOOKUPS) {
+        std::printf("error: %zu of %zu lookups failed\n", LOOKUPS - found, LOOKUPS);
+    }
+    return total / LOOKUPS;
+}
+
+int main() {
+    const size_t BRANCHES = 100000;
+    std::mt19937 rng(42);
+    AVLTree tree;
+    bool ok = true;
+
+    std::printf("AVL branch tree benchmark: %zu branches created in sorted order\n\n", BRANCHES);
+    std::printf("%10s %8s %10s %14s %14s\n", "branches", "height", "1.44log2n", "insert ns/op", "lookup ns/op");
+
+    size_t created = 0;
+    for (size_t checkpoint = 1000; checkpoint <= BRANCHES; checkpoint *= 10) {
+        size_t before = created;
+        Clock::time_point start = Clock::now();
+        for (; created < checkpoint; ++created) {
+            ok &= tree.insert(BranchInfo(branch_name(created), "commit" + std::to_string(created % 97), "now"));
+        }
+        double insert_ns = elapsed_ns(start) / (checkpoint - before);
+
+        double bound = 1.44 * std::log2(static_cast<double>(checkpoint) + 2);
+        std::printf("%10zu %8d %10.1f %14.0f %14.0f\n", checkpoint, tree.get_height(), bound,
+                    insert_ns, lookup_ns(tree, checkpoint, rng));
+        ok &= tree.get_height() <= bound;
+    }
+
+    // Delete every other branch in order, then the rest in random order
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < BRANCHES; i += 2) {
+        ok &= tree.remove(branch_name(i));
+    }
+    std::vector<size_t> rest;
+    for (size_t i = 1; i < BRANCHES; i += 2) {
+        rest.push_back(i);
+    }
+    std::shuffle(rest.begin(), rest.end(), rng);
+    int half_height = tree.get_height();
+    for (size_t i : rest) {
+        ok &= tree.remove(branch_name(i));
+    }
+    double delete_ns = elapsed_ns(start) / BRANCHES;
+
+    std::printf("\nDeleted %zu branches: %.0f ns/op, height %d at %zu branches, %d after\n",
+                BRANCHES, delete_ns, half_height, BRANCHES / 2, tree.get_height());
+    ok &= tree.size() == 0 && tree.get_height() == 0;
+
+    std::printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
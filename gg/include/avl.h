@@ -2,7 +2,9 @@
  * avl.h - AVL Tree for branch management
  * 
  * The self-balancing AVL Tree is used to efficiently store, search,
- * and visualize branches in the repository.
+ * and visualize branches in the repository. Every node's subtrees differ
+ * in height by at most one, so the tree stays about 1.44 log2(n) deep even
+ * when branches are created in sorted order.
  */
 
 #ifndef AVL_H
@@ -12,6 +14,10 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
 #include <ncurses.h>
 
 // Branch info structure
@@ -20,6 +26,7 @@ struct BranchInfo {
     std::string commit_id;
     std::string creation_time;
     std::string latest_commit_time;
+    int64_t commit_time = 0; // latest_commit_time in seconds, for sorting
     
     BranchInfo() = default;
     BranchInfo(const std::string& name, const std::string& commit_id, 
@@ -38,25 +45,47 @@ public:
     int balance_factor() const;
 };
 
+// Orders branches by latest commit time, then by name
+struct RecencyOrder {
+    bool operator()(const BranchInfo* a, const BranchInfo* b) const;
+};
+
 // AVL Tree for branches
 class AVLTree {
 private:
     std::shared_ptr<AVLNode> root;
-    std::map<std::string, std::shared_ptr<AVLNode>> branch_map; // name -> node
+    size_t branch_count;
+    std::unordered_map<std::string, std::set<std::string>> commit_branches; // commit id -> names
+    
+    // Secondary index by commit time. Each branch stays in the same node
+    // for as long as it is in the tree, so the index can point into nodes.
+    std::set<const BranchInfo*, RecencyOrder> recency;
+    
+    // Names inserted, updated or removed since the last clear_changed()
+    std::set<std::string> changed;
     
     // Helper methods
-    int height(std::shared_ptr<AVLNode> node) const;
+    int height(const std::shared_ptr<AVLNode>& node) const;
+    void update_height(const std::shared_ptr<AVLNode>& node);
     std::shared_ptr<AVLNode> right_rotate(std::shared_ptr<AVLNode> y);
     std::shared_ptr<AVLNode> left_rotate(std::shared_ptr<AVLNode> x);
-    std::shared_ptr<AVLNode> insert_node(std::shared_ptr<AVLNode> node, const BranchInfo& branch);
-    std::shared_ptr<AVLNode> delete_node(std::shared_ptr<AVLNode> root, const std::string& branch_name);
-    std::shared_ptr<AVLNode> min_value_node(std::shared_ptr<AVLNode> node) const;
-    void in_order_traversal(std::shared_ptr<AVLNode> node, std::vector<BranchInfo>& branches) const;
-    void draw_node(WINDOW* win, std::shared_ptr<AVLNode> node, int y, int x, 
-                  int h_offset, const std::string& current_branch) const;
+    std::shared_ptr<AVLNode> rebalance(std::shared_ptr<AVLNode> node);
+    std::shared_ptr<AVLNode> insert_node(std::shared_ptr<AVLNode> node, const BranchInfo& branch, bool& inserted);
+    std::shared_ptr<AVLNode> delete_node(std::shared_ptr<AVLNode> node, const std::string& branch_name, bool& removed);
+    std::shared_ptr<AVLNode> detach_min(std::shared_ptr<AVLNode> node, std::shared_ptr<AVLNode>& min);
+    AVLNode* find_node(const std::string& branch_name) const;
+    void in_order_traversal(const std::shared_ptr<AVLNode>& node, std::vector<BranchInfo>& branches) const;
+    void unlink_commit(const std::string& commit_id, const std::string& branch_name);
+    std::shared_ptr<AVLNode> build_sorted(const std::vector<BranchInfo>& branches, size_t begin, size_t end);
 
 public:
     AVLTree();
+    // The recency index points into this tree's nodes, so trees move but
+    // do not copy
+    AVLTree(const AVLTree& other) = delete;
+    AVLTree& operator=(const AVLTree& other) = delete;
+    AVLTree(AVLTree&& other) = default;
+    AVLTree& operator=(AVLTree&& other) = default;
     
     // Core operations
     bool insert(const BranchInfo& branch);
@@ -67,11 +96,32 @@ public:
     
     // Tree traversal
     std::vector<BranchInfo> get_all_branches() const;
+    size_t size() const;
+    int get_height() const;
+    
+    // Visit branches in name order starting at the first name >= from,
+    // until the visitor returns false. Only the O(log n) path down to the
+    // start and the nodes actually visited are touched.
+    void scan_from(const std::string& from, const std::function<bool(const BranchInfo&)>& visit) const;
+    
+    // Visit branches by latest commit time, newest or oldest first, until
+    // the visitor returns false; the first N cost O(log n + N)
+    void scan_by_time(bool newest_first, const std::function<bool(const BranchInfo&)>& visit) const;
+    
+    // Reverse lookups: the branches pointing at a commit, sorted by name,
+    // and each distinct commit some branch points at
+    std::vector<std::string> branches_at(const std::string& commit_id) const;
+    std::vector<std::string> get_branch_commits() const;
+    
+    // Branches changed since the tree was loaded, for incremental saves
+    const std::set<std::string>& changed_branches() const;
+    void clear_changed();
     
     // Visualization
     void draw(WINDOW* win, int start_y, int start_x, const std::string& current_branch) const;
     
-    // Serialization
+    // Serialization. Branches are written in name order, and a sorted
+    // list is rebuilt into a balanced tree in O(n) without rotations.
     std::string serialize() const;
     static AVLTree deserialize(const std::string& data);
 };
@@ -0,0 +1,64 @@
+/**
+ * bitmap.h - EWAH compressed bitmaps
+ *
+ * Enhanced Word-Aligned Hybrid (EWAH) bitmaps store a bit set as 64-bit
+ * words, replacing runs of all-zero or all-one words with a single marker
+ * word. Each marker holds the fill bit, the length of the run (32 bits),
+ * and the number of literal words that follow it (31 bits). Sets of commits
+ * reachable from a tip are mostly long runs of ones, so they compress to a
+ * few words, and AND/OR/AND-NOT process whole runs at a time.
+ */
+
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+// EWAH-compressed bitmap
+class EWAHBitmap {
+private:
+    std::vector<uint64_t> words;   // Markers, each followed by its literal words
+    size_t last_marker;            // Position of the marker being extended
+    size_t bit_count;              // Size in bits, including trailing zeros
+
+    void add_fill(bool bit, uint64_t count);
+    void add_literal(uint64_t word);
+    void add_word(uint64_t word);
+
+    template <typename Op>
+    EWAHBitmap combine(const EWAHBitmap& other, Op op) const;
+
+public:
+    static const uint64_t MAX_RUN = 0xFFFFFFFFULL;
+    static const uint64_t MAX_LITERALS = 0x7FFFFFFFULL;
+
+    EWAHBitmap();
+
+    // Compress an uncompressed bitmap of the given size in bits
+    static EWAHBitmap from_words(const std::vector<uint64_t>& dense, size_t bits);
+
+    bool get(size_t bit) const;
+    size_t count() const;
+    size_t size_in_bits() const;
+    size_t size_in_bytes() const;
+
+    // Set operations; the result is as long as the longer operand
+    EWAHBitmap logical_and(const EWAHBitmap& other) const;
+    EWAHBitmap logical_or(const EWAHBitmap& other) const;
+    EWAHBitmap logical_andnot(const EWAHBitmap& other) const;
+
+    // Set bits of an uncompressed bitmap; bits past its end are dropped
+    void or_into(std::vector<uint64_t>& dense) const;
+
+    // Visit set bits in increasing order until the visitor returns false
+    void for_each(const std::function<bool(size_t)>& visitor) const;
+
+    // Serialization
+    std::string serialize() const;
+    static EWAHBitmap deserialize(const std::string& data);
+};
+
+#endif // BITMAP_H
@@ -1,8 +1,12 @@
 /**
- * bloom.h - Bloom Filter for file existence checking
+ * bloom.h - Cache-line-blocked Bloom filter
  * 
  * The Bloom Filter provides a space-efficient probabilistic data structure
- * for quickly checking if a file is being tracked in the repository.
+ * for quickly checking whether a key may be in a set.
+ *
+ * Each key is hashed once and all of its bits fall in one 64-byte block, so
+ * a membership test touches a single cache line. The changed-path index
+ * keeps one such filter per commit.
  */
 
 #ifndef BLOOM_H
@@ -10,48 +14,52 @@
 
 #include <string>
 #include <vector>
-#include <array>
-#include <functional>
+#include <cstdint>
 #include <ncurses.h>
 
-// Bloom Filter for rapid existence checks
-class BloomFilter {
-private:
+// Bloom filter whose probes for a key all land in one cache-line block
+class BlockedBloomFilter {
+public:
+    static const size_t BLOCK_BITS = 512;
     static const size_t DEFAULT_SIZE = 1024;
-    static const size_t HASH_FUNCTIONS = 3;
-    
-    std::vector<bool> bit_array;
-    size_t size;
-    std::array<std::hash<std::string>, HASH_FUNCTIONS> hash_functions;
+    static const size_t DEFAULT_HASHES = 7;
+    static constexpr size_t MAX_HASHES = 16;
+
+private:
+    // One cache line of filter bits
+    struct alignas(64) Block {
+        uint64_t words[BLOCK_BITS / 64];
+    };
+
+    std::vector<Block> blocks;
+    size_t hash_count;
     size_t item_count;
-    
-    // Hash functions
-    size_t hash1(const std::string& key) const;
-    size_t hash2(const std::string& key) const;
-    size_t hash3(const std::string& key) const;
-    
-    // Helper methods
-    void draw_bits(WINDOW* win, int start_y, int start_x, int width, int height) const;
+    size_t bits_set;
+
+    // Block index and in-block bit mask for a key, from a single hash
+    size_t block_for(uint64_t hash) const;
+    void make_mask(uint64_t hash, uint64_t mask[BLOCK_BITS / 64]) const;
 
 public:
-    BloomFilter(size_t size = DEFAULT_SIZE);
-    
+    BlockedBloomFilter(size_t size = DEFAULT_SIZE, size_t hash_count = DEFAULT_HASHES);
+
     // Core operations
     void add(const std::string& item);
     bool might_contain(const std::string& item) const;
     void clear();
-    
+
     // Statistics
     double false_positive_probability() const;
     size_t get_item_count() const;
     size_t get_size() const;
-    
+    size_t get_hash_count() const;
+
     // Visualization
     void draw(WINDOW* win, int start_y, int start_x, int width, int height) const;
-    
+
     // Serialization
     std::string serialize() const;
-    static BloomFilter deserialize(const std::string& data);
+    static BlockedBloomFilter deserialize(const std::string& data);
 };
 
 #endif // BLOOM_H
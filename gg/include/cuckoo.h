@@ -0,0 +1,86 @@
+/**
+ * cuckoo.h - Cuckoo filter for file existence checking
+ *
+ * A cuckoo filter answers the same "definitely not / maybe" question as a
+ * Bloom filter but stores a short fingerprint per key instead of setting
+ * shared bits, so a key can be removed again. Untracking files therefore
+ * lowers the false-positive rate instead of leaving stale bits behind.
+ *
+ * Each key has two candidate buckets of four 16-bit fingerprints; a bucket
+ * is one 64-bit word, so a lookup reads at most two words. The table is
+ * sized from the number of keys it must hold and a target false-positive
+ * rate: the rate grows with the load, so a stricter target leaves more
+ * slots empty.
+ */
+
+#ifndef CUCKOO_H
+#define CUCKOO_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ncurses.h>
+
+// Cuckoo filter with deletion
+class CuckooFilter {
+public:
+    static const size_t SLOTS_PER_BUCKET = 4;
+    static const size_t FINGERPRINT_BITS = 16;
+    static const size_t MAX_KICKS = 500;
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    static constexpr double DEFAULT_TARGET_FPR = 0.01;
+    static constexpr double MAX_LOAD = 0.95;
+
+private:
+    std::vector<uint64_t> buckets; // Four fingerprints per bucket, 0 = empty
+    size_t item_count;
+    uint64_t kick_state;           // Picks which slot to evict
+    bool dirty;                    // Changed since the last save
+
+    // A fingerprint evicted by a failed insertion. It is still a member,
+    // and the filter reports itself full until it is rebuilt.
+    bool has_victim;
+    uint16_t victim_fingerprint;
+    size_t victim_bucket;
+
+    size_t alternate_bucket(size_t bucket, uint16_t fingerprint) const;
+    void locate(const std::string& item, uint16_t& fingerprint, size_t& first, size_t& second) const;
+    bool bucket_contains(size_t bucket, uint16_t fingerprint) const;
+    bool bucket_insert(size_t bucket, uint16_t fingerprint);
+    bool bucket_remove(size_t bucket, uint16_t fingerprint);
+
+public:
+    // Room for at least capacity keys with the expected false-positive
+    // rate still within target_fpr
+    CuckooFilter(size_t capacity = DEFAULT_CAPACITY, double target_fpr = DEFAULT_TARGET_FPR);
+
+    // Highest load whose expected false-positive rate is within target_fpr
+    static double max_load(double target_fpr);
+
+    // Core operations. Once is_full(), add() may fail to store a key and
+    // return false; the caller should rebuild with more capacity. Only
+    // keys that were added may be removed.
+    bool add(const std::string& item);
+    bool might_contain(const std::string& item) const;
+    bool remove(const std::string& item);
+    void clear();
+
+    // Statistics
+    double false_positive_probability() const;
+    double load_factor() const;
+    size_t get_item_count() const;
+    size_t get_capacity() const;
+    size_t get_size() const;
+    bool is_full() const;
+    bool is_dirty() const;
+    void clear_dirty();
+
+    // Visualization
+    void draw(WINDOW* win, int start_y, int start_x, int width, int height) const;
+
+    // Serialization
+    std::string serialize() const;
+    static CuckooFilter deserialize(const std::string& data);
+};
+
+#endif // CUCKOO_H
@@ -1,8 +1,14 @@
 /**
  * dag.h - Directed Acyclic Graph for commit history
- * 
+ *
  * The DAG represents the commit history in gg, allowing for non-linear
  * history tracking and visualization of the project's evolution.
+ *
+ * Commits are numbered with 32-bit indices in the order they are added, so
+ * every parent has a smaller index than its children. Edges are kept in
+ * compressed sparse row (CSR) form: one flat array of parent indices with
+ * per-commit offsets into it, and the same for children. Traversals walk
+ * these arrays instead of chasing pointers between heap-allocated nodes.
  */
 
 #ifndef DAG_H
@@ -11,7 +17,7 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <memory>
+#include <cstdint>
 #include <ncurses.h>
 
 // Commit structure
@@ -24,58 +30,79 @@ struct Commit {
     std::map<std::string, std::string> file_snapshots; // filename -> content hash
 
     Commit() = default;
-    Commit(const std::string& id, const std::string& message, 
+    Commit(const std::string& id, const std::string& message,
            const std::string& author, const std::string& timestamp);
 };
 
-// Node in the commit graph
-class DAGNode {
-public:
-    Commit commit;
-    std::vector<std::shared_ptr<DAGNode>> parents;
-    std::vector<std::shared_ptr<DAGNode>> children;
-    
-    DAGNode(const Commit& commit);
-    void add_parent(std::shared_ptr<DAGNode> parent);
-    void add_child(std::shared_ptr<DAGNode> child);
+// Position of a commit in the graph
+typedef uint32_t CommitIndex;
+static const CommitIndex NO_COMMIT = UINT32_MAX;
+
+// A run of commit indices inside one of the edge arrays
+struct CommitRange {
+    const CommitIndex* first;
+    const CommitIndex* last;
+
+    const CommitIndex* begin() const { return first; }
+    const CommitIndex* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
 };
 
 // Directed Acyclic Graph for commits
 class DAG {
 private:
-    std::map<std::string, std::shared_ptr<DAGNode>> nodes; // commit_id -> node
-    std::shared_ptr<DAGNode> head;
-    
-    // Helper methods for visualization
-    void draw_node(WINDOW* win, std::shared_ptr<DAGNode> node, int y, int x, 
-                  std::map<std::string, std::pair<int, int>>& positions, 
-                  const std::string& current_commit) const;
-    void calculate_positions(std::shared_ptr<DAGNode> node, 
-                            std::map<std::string, std::pair<int, int>>& positions, 
-                            int& max_depth, int depth, int& x_offset) const;
+    std::vector<Commit> commits;            // Indexed by CommitIndex
+
+    // Parents of commit i are parent_list[parent_offsets[i] .. parent_offsets[i + 1])
+    std::vector<uint32_t> parent_offsets;
+    std::vector<CommitIndex> parent_list;
+
+    // Children, in the same form. Derived from the parents and rebuilt
+    // on first use after commits are added.
+    mutable std::vector<uint32_t> child_offsets;
+    mutable std::vector<CommitIndex> child_list;
+    mutable bool children_valid;
+
+    // Commit id -> index: open addressing over indices, compared through
+    // commits[] so each id is stored only once
+    std::vector<CommitIndex> id_slots;
+
+    CommitIndex head;
+    bool dirty; // Commits added or head moved since the last save
+
+    void build_children() const;
+    void insert_id(CommitIndex index);
+    void grow_id_table();
 
 public:
     DAG();
-    
+
     // Core operations
-    std::shared_ptr<DAGNode> add_commit(const Commit& commit, 
-                                       const std::vector<std::string>& parent_ids);
-    std::shared_ptr<DAGNode> get_commit(const std::string& commit_id) const;
+    CommitIndex add_commit(const Commit& commit, const std::vector<std::string>& parent_ids);
+    CommitIndex find(const std::string& commit_id) const;
+    const Commit* get_commit(const std::string& commit_id) const;
+    const Commit& commit_at(CommitIndex index) const;
     bool set_head(const std::string& commit_id);
-    std::shared_ptr<DAGNode> get_head() const;
-    
-    // Graph traversal
-    std::vector<std::shared_ptr<DAGNode>> get_ancestors(const std::string& commit_id) const;
-    std::vector<std::shared_ptr<DAGNode>> breadth_first_search() const;
-    std::vector<std::shared_ptr<DAGNode>> depth_first_search() const;
-    
-    // Merging
-    std::shared_ptr<DAGNode> merge_branches(const std::string& commit_id, 
-                                           const std::string& message);
-    
+    CommitIndex get_head() const;
+    size_t size() const;
+    bool is_dirty() const;
+    void clear_dirty();
+
+    // Adjacency
+    CommitRange parents(CommitIndex index) const;
+    CommitRange children(CommitIndex index) const;
+
+    // Every commit reachable from commit_id along parent edges, nearest first
+    std::vector<CommitIndex> get_ancestors(const std::string& commit_id) const;
+
+    // Graph traversal from the head (root) commit along child edges
+    std::vector<CommitIndex> breadth_first_search() const;
+    std::vector<CommitIndex> depth_first_search() const;
+
     // Visualization
     void draw(WINDOW* win, const std::string& current_commit) const;
-    
+
     // Serialization
     std::string serialize() const;
     static DAG deserialize(const std::string& data);
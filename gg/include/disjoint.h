@@ -28,6 +28,7 @@ public:
 class DisjointSet {
 private:
     std::unordered_map<std::string, std::shared_ptr<DisjointNode>> nodes;
+    bool dirty; // Sets added or joined since the last save (path compression doesn't count)
     
     // Helper methods
     std::shared_ptr<DisjointNode> find_set_node(std::shared_ptr<DisjointNode> node);
@@ -41,6 +42,8 @@ public:
     void make_set(const std::string& key);
     std::string find_set(const std::string& key);
     bool union_sets(const std::string& key1, const std::string& key2);
+    bool is_dirty() const;
+    void clear_dirty();
     
     // Connected component operations
     bool are_connected(const std::string& key1, const std::string& key2);
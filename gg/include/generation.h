@@ -0,0 +1,58 @@
+/**
+ * generation.h - Generation numbers and merge bases for the commit graph
+ *
+ * A commit's generation is one more than the largest generation of its
+ * parents, so a commit can only be an ancestor of commits with a larger
+ * generation. Walking commits in decreasing generation order therefore
+ * reaches every descendant of a commit before the commit itself, which lets
+ * the merge-base walk stop as soon as nothing left in its queue can still
+ * be a common ancestor. Generations and commit dates are kept in
+ * .gg/commit-graph alongside the DAG.
+ */
+
+#ifndef GENERATION_H
+#define GENERATION_H
+
+#include "dag.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Result of walking two tips down to their merge bases
+struct MergeBaseWalk {
+    std::vector<CommitIndex> bases;       // Best common ancestors
+    std::vector<CommitIndex> only_ours;   // Reachable from ours but not from a base
+    std::vector<CommitIndex> only_theirs; // Reachable from theirs but not from a base
+    size_t visited = 0;                   // Commits taken off the queue
+};
+
+// Per-commit generation numbers and dates, indexed like the DAG
+class GenerationIndex {
+private:
+    std::vector<uint32_t> generations;
+    std::vector<int64_t> dates;     // Seconds since the epoch
+    std::string last_id;            // Id of the last covered commit
+    bool dirty = false;             // Extended or recomputed since the last save
+
+public:
+    // Extend the index to every commit in the DAG. An index that does not
+    // match the DAG (e.g. written for a different history) is recomputed.
+    void update(const DAG& dag);
+
+    uint32_t generation(CommitIndex index) const;
+    int64_t date(CommitIndex index) const;
+    size_t size() const;
+    bool is_dirty() const;
+    void clear_dirty();
+
+    // Ancestry queries; both sides must be covered by update()
+    MergeBaseWalk walk(const DAG& dag, CommitIndex ours, CommitIndex theirs) const;
+    CommitIndex merge_base(const DAG& dag, CommitIndex ours, CommitIndex theirs) const;
+    bool is_ancestor(const DAG& dag, CommitIndex ancestor, CommitIndex descendant) const;
+
+    // Serialization
+    std::string serialize() const;
+    static GenerationIndex deserialize(const std::string& data);
+};
+
+#endif // GENERATION_H
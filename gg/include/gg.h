@@ -25,7 +25,11 @@ class DAG;
 class AVLTree;
 class SkipList;
 class DisjointSet;
-class BloomFilter;
+class CuckooFilter;
+class GenerationIndex;
+class ReachabilityIndex;
+class RefStore;
+class StagingIndex;
 
 // Simplified version without ncurses
 #ifdef NCURSES_DISABLED
@@ -48,31 +52,64 @@ enum Color {
     COLOR_HIGHLIGHT
 };
 
+// A movement of HEAD or a branch, written to its reflog by GGRepo::save()
+struct RefMove {
+    std::string branch; // Empty for HEAD
+    std::string old_id;
+    std::string new_id;
+    std::string reason;
+};
+
 // Global state of the gg repository
 struct GGRepo {
+    // False-positive rate the file filter is sized for
+    static constexpr double FILE_FILTER_TARGET_FPR = 0.01;
+
     std::string current_branch;
     std::string head_commit;
     std::shared_ptr<Trie> file_trie;
     std::shared_ptr<DAG> commit_graph;
+    std::shared_ptr<GenerationIndex> generations;
     std::shared_ptr<AVLTree> branches;
+    std::shared_ptr<RefStore> refs;
     std::shared_ptr<SkipList> commit_list;
     std::shared_ptr<DisjointSet> merge_sets;
-    std::shared_ptr<BloomFilter> file_filter;
+    std::shared_ptr<CuckooFilter> file_filter;
+    std::shared_ptr<ReachabilityIndex> reachability;
+    std::shared_ptr<StagingIndex> index;
+    std::string saved_head; // HEAD as last read or written
+    std::vector<RefMove> ref_moves; // Logged once the state is saved
     bool exists() const;
     static GGRepo load();
-    void save() const;
+    bool save();
+    void log_head_move(const std::string& old_id, const std::string& new_id, const std::string& reason);
+    void log_branch_move(const std::string& branch, const std::string& old_id,
+                         const std::string& new_id, const std::string& reason);
+    void rebuild_file_filter();
 };
 
 // Repository operations
 bool init_repository();
 bool add_file(const std::string& filepath);
+bool remove_file(const std::string& filepath, bool keep_file);
 bool commit_changes(const std::string& message);
 bool create_branch(const std::string& name);
+bool switch_branch(const std::string& name);
+void list_branches(const std::string& contains = "");
+void list_matching_branches(const std::string& pattern);
+bool list_sorted_branches(const std::string& sort_key, size_t count = 0);
+bool parse_branch_count(const std::string& option, size_t& count);
+bool pack_refs();
 bool merge_branch(const std::string& name);
 void show_status();
-void show_log();
+void show_log(const std::string& path = "", const std::string& range = "");
+bool show_reflog(const std::string& ref = "HEAD", const std::string& at = "");
 void learn_topic(const std::string& topic);
 
+// UI mode: headless runs skip ncurses entirely and print plain text
+void set_headless_mode(bool headless);
+bool is_headless_mode();
+
 // UI functions
 void init_ui();
 void cleanup_ui();
@@ -102,12 +139,11 @@ public:
 };
 
 // Utility functions
-std::string generate_commit_id();
 std::string get_current_time_string();
 std::vector<std::string> split_string(const std::string& str, char delimiter);
 bool file_exists(const std::string& filepath);
 std::string read_file_contents(const std::string& filepath);
-void write_file_contents(const std::string& filepath, const std::string& contents);
+bool write_file_contents(const std::string& filepath, const std::string& contents);
 
 // Learn function declarations
 void learn_dag();
@@ -0,0 +1,52 @@
+/**
+ * hash.h - SHA-256 content hashing for the object store
+ *
+ * Objects are identified by the SHA-256 of their contents. On x86 CPUs with
+ * the SHA extensions the compression function runs on SHA-NI instructions,
+ * selected once at runtime; everywhere else a portable version is used.
+ *
+ * hash64() is a fast non-cryptographic 64-bit hash (wyhash) for in-memory
+ * structures such as the Bloom filters.
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Incremental SHA-256 hasher
+class Sha256 {
+private:
+    uint32_t state[8];
+    uint8_t block[64];
+    size_t block_length;
+    uint64_t total_length;
+
+public:
+    static const size_t DIGEST_SIZE = 32;
+
+    Sha256();
+
+    void reset();
+    void update(const void* data, size_t length);
+    void update(const std::string& data);
+    std::string finish_hex();
+
+    // True when the hardware-accelerated path is in use
+    static bool hardware_accelerated();
+};
+
+// Hash a buffer in one call and return the lowercase hex digest
+std::string sha256_hex(const std::string& data);
+
+// Hex digests are 64 characters in memory and 32 raw bytes on disk
+std::string hex_to_bytes(const std::string& hex);
+std::string bytes_to_hex(const std::string& bytes);
+
+// Fast 64-bit hash with good avalanche, for hash tables and filters
+uint64_t hash64(const void* data, size_t length, uint64_t seed = 0);
+uint64_t hash64(const std::string& data, uint64_t seed = 0);
+
+#endif // HASH_H
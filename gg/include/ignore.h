@@ -0,0 +1,114 @@
+/**
+ * ignore.h - .ggignore pattern matching
+ *
+ * Patterns follow the usual gitignore rules: '#' comments, '!' negation,
+ * a trailing '/' for directories only, and a leading or inner '/' anchoring
+ * the pattern to the repository root (otherwise it matches the file name at
+ * any depth). The last matching pattern wins.
+ *
+ * Each pattern is compiled once. Plain names, "prefix*" and "*suffix"
+ * patterns are matched with a single string comparison; everything else
+ * runs on a small glob automaton. Directories are checked before they are
+ * opened, and their results are cached in .gg/ignore between runs.
+ */
+
+#ifndef IGNORE_H
+#define IGNORE_H
+
+#include <string>
+#include <vector>
+#include <bitset>
+#include <unordered_map>
+#include <cstdint>
+
+// Files used for ignore handling
+#define GGIGNORE_FILE ".ggignore"
+#define IGNORE_CACHE_FILE ".gg/ignore"
+
+// One step of a compiled glob
+struct GlobToken {
+    enum class Type : uint8_t {
+        CHAR,        // Literal character
+        ANY,         // '?': one character except '/'
+        CLASS,       // '[...]': one character from a set, except '/'
+        STAR,        // '*': any run of characters except '/'
+        DOUBLE_STAR, // '**': any run of characters
+        ANY_DIRS     // '**/': empty, or any run ending in '/'
+    };
+
+    Type type;
+    char c;
+    std::bitset<256> set;
+
+    GlobToken(Type type, char c = 0) : type(type), c(c) {}
+};
+
+// One compiled line of .ggignore
+struct IgnorePattern {
+    enum class Kind : uint8_t {
+        LITERAL, // Whole subject equals text
+        PREFIX,  // Subject starts with text, rest has no '/'
+        SUFFIX,  // Subject ends with text, rest has no '/'
+        GLOB     // Run the glob automaton
+    };
+
+    Kind kind;
+    std::string text;
+    std::vector<GlobToken> glob;
+    bool negated;
+    bool directory_only;
+    bool anchored; // Match the full path instead of the file name
+
+    IgnorePattern() : kind(Kind::LITERAL), negated(false), directory_only(false), anchored(false) {}
+
+    bool matches(const std::string& path, const std::string& name) const;
+};
+
+// Compiled .ggignore with a per-directory result cache
+class IgnoreMatcher {
+private:
+    std::vector<IgnorePattern> patterns;
+    std::string signature; // Hash of the .ggignore contents
+
+    // Directories looked up by one walker thread during this run
+    struct SeenDirs {
+        std::unordered_map<std::string, bool> dirs;
+        bool changed = false; // A result was not in the cache
+    };
+
+    // Directory results: loaded from the cache file (read-only while
+    // walking) and one map per worker, merged when the cache is saved
+    std::unordered_map<std::string, bool> cached_dirs;
+    std::vector<SeenDirs> seen;
+
+public:
+    // Globs are simulated with one bit per token
+    static const size_t MAX_GLOB_TOKENS = 63;
+
+    IgnoreMatcher();
+
+    // Parse and compile a .ggignore file (a missing file ignores nothing)
+    bool load(const std::string& filepath = GGIGNORE_FILE);
+    bool add_pattern(const std::string& line);
+    bool empty() const;
+    const std::string& get_signature() const;
+
+    // Evaluate the patterns for one path (relative, no leading "./")
+    bool matches(const std::string& path, bool is_dir) const;
+
+    // Prepare one result map per walker thread; call before walking
+    void set_worker_count(size_t count);
+
+    // As matches(), with directory results served from the cache. Threads
+    // may call this concurrently as long as each passes its own worker.
+    bool is_ignored(const std::string& path, bool is_dir, size_t worker = 0);
+
+    // True if the path or any of its parent directories is ignored
+    bool is_path_ignored(const std::string& path, size_t worker = 0);
+
+    // Directory cache, valid only for the same .ggignore contents
+    bool load_cache(const std::string& filepath = IGNORE_CACHE_FILE);
+    bool save_cache(const std::string& filepath = IGNORE_CACHE_FILE);
+};
+
+#endif // IGNORE_H
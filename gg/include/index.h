@@ -0,0 +1,65 @@
+/**
+ * index.h - Binary staging index with a stat cache
+ *
+ * The index records, for every tracked path, the blob hash of the staged or
+ * committed contents together with the file's size, mtime, inode and mode.
+ * A file whose stat data still matches its entry is known to be unchanged
+ * without reading it, so status only rehashes files that were touched.
+ */
+
+#ifndef INDEX_H
+#define INDEX_H
+
+#include <string>
+#include <map>
+#include <cstdint>
+
+class ObjectStore;
+
+// One tracked path
+struct IndexEntry {
+    std::string path;
+    std::string blob_id;
+    uint64_t size;
+    int64_t mtime_ns;
+    uint64_t inode;
+    uint32_t mode;
+
+    IndexEntry() : size(0), mtime_ns(0), inode(0), mode(0) {}
+};
+
+// Staging index stored in .gg/index
+class StagingIndex {
+private:
+    std::map<std::string, IndexEntry> entries; // path -> entry
+    int64_t index_mtime_ns; // mtime of the index file when it was loaded
+    bool dirty;
+
+    static bool stat_file(const std::string& path, IndexEntry& entry);
+    bool is_racily_clean(const IndexEntry& entry) const;
+
+public:
+    StagingIndex();
+
+    // Core operations
+    bool update(const std::string& path, const std::string& blob_id);
+    bool remove(const std::string& path);
+    const IndexEntry* find(const std::string& path) const;
+    size_t size() const;
+
+    // Modification check; entries whose stat data changed but whose
+    // contents did not are refreshed so the next check is stat-only
+    bool check_modified(const std::string& path, ObjectStore& store);
+    bool is_dirty() const;
+
+    // Serialization
+    std::string serialize() const;
+    static StagingIndex deserialize(const std::string& data);
+
+    // Persistence
+    static StagingIndex load(const std::string& filepath = ".gg/index");
+    // Returns false, leaving the index dirty, if it could not be written
+    bool save(const std::string& filepath = ".gg/index");
+};
+
+#endif // INDEX_H
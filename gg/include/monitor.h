@@ -0,0 +1,68 @@
+/**
+ * monitor.h - Filesystem monitor and change journal
+ *
+ * The monitor is an optional background process that watches the worktree
+ * with inotify and appends every changed path to .gg/monitor/journal,
+ * numbered with an increasing sequence token. Status asks the journal for
+ * "paths changed since token X" and only examines those paths. When the
+ * journal cannot answer (monitor not running, restarted, or overflowed),
+ * status falls back to a full scan.
+ *
+ * Before trusting the journal, status creates a cookie file in
+ * .gg/monitor/ and waits for the monitor to journal it. inotify delivers
+ * events in order, so every change made before the cookie is in the
+ * journal by then.
+ */
+
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <cstdint>
+
+// Files used by the monitor
+#define MONITOR_DIR ".gg/monitor"
+#define MONITOR_JOURNAL_FILE ".gg/monitor/journal"
+#define MONITOR_PID_FILE ".gg/monitor/pid"
+#define MONITOR_STATUS_FILE ".gg/monitor/status"
+#define MONITOR_LOG_FILE ".gg/monitor/log"
+#define MONITOR_COOKIE_PREFIX "cookie-"
+
+// How long status waits for the monitor to journal its cookie
+#define MONITOR_SYNC_TIMEOUT_MS 500
+
+// Read-only view of the change journal
+class ChangeJournal {
+private:
+    uint64_t epoch;     // Changes whenever the journal is reset
+    uint64_t latest;    // Sequence token of the newest record
+    std::vector<std::pair<uint64_t, std::string>> records; // token -> path
+
+public:
+    // Journal limit; the monitor resets the journal (new epoch) past this
+    static const size_t MAX_RECORDS = 100000;
+
+    ChangeJournal();
+
+    bool load(const std::string& filepath = MONITOR_JOURNAL_FILE);
+    uint64_t get_epoch() const;
+    uint64_t get_latest_token() const;
+
+    // Collect paths changed after (epoch, token). Returns false if the
+    // journal cannot answer and the caller must do a full scan.
+    bool changes_since(uint64_t since_epoch, uint64_t since_token, std::set<std::string>& paths) const;
+};
+
+// Load a journal that covers every change made before the call, using a
+// cookie file. Returns false if the monitor did not catch up in time.
+bool sync_with_monitor(ChangeJournal& journal, int timeout_ms = MONITOR_SYNC_TIMEOUT_MS);
+
+// Monitor process control
+bool monitor_is_running();
+bool start_monitor();
+bool stop_monitor();
+void run_monitor();
+
+#endif // MONITOR_H
@@ -0,0 +1,53 @@
+/**
+ * objects.h - Content-addressed object store
+ *
+ * File contents (blobs) and commits are stored under .gg/objects, named by
+ * the SHA-256 of their contents and fanned out into 256 subdirectories by
+ * the first two hex digits. Identical contents are therefore stored once,
+ * and commit IDs are derived from what the commit records.
+ */
+
+#ifndef OBJECTS_H
+#define OBJECTS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct Commit;
+
+// Kinds of stored objects
+enum class ObjectType : uint8_t {
+    BLOB = 1,
+    COMMIT = 2
+};
+
+// Object store rooted at .gg/objects
+class ObjectStore {
+private:
+    std::string root;
+    std::vector<char> buffer; // Reusable chunk buffer for streaming ingest
+
+    std::string object_path(const std::string& id) const;
+    std::string ingest_file(const std::string& filepath, bool store);
+
+public:
+    static const size_t CHUNK_SIZE = 1 << 20;
+
+    ObjectStore(const std::string& root = ".gg/objects");
+
+    // Core operations
+    static std::string hash_object(ObjectType type, const std::string& data);
+    std::string write_object(ObjectType type, const std::string& data);
+    bool read_object(const std::string& id, ObjectType& type, std::string& data) const;
+    bool has_object(const std::string& id) const;
+
+    // Blobs and commits; files are streamed in CHUNK_SIZE pieces, so memory
+    // use stays bounded regardless of file size
+    std::string write_blob_from_file(const std::string& filepath);
+    std::string hash_blob_from_file(const std::string& filepath);
+    std::string write_commit(const Commit& commit);
+    static std::string encode_commit(const Commit& commit);
+};
+
+#endif // OBJECTS_H
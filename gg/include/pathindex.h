@@ -0,0 +1,50 @@
+/**
+ * pathindex.h - Changed-path Bloom filters for path-limited history
+ *
+ * Every commit gets a small Bloom filter of the paths it changed, plus the
+ * directories containing them, so "did this commit touch src/net?" is
+ * answered with a filter probe instead of a scan of its snapshot. Filters
+ * are appended to .gg/changed-paths as commits are created.
+ */
+
+#ifndef PATHINDEX_H
+#define PATHINDEX_H
+
+#include "bloom.h"
+#include <string>
+#include <unordered_map>
+
+struct Commit;
+
+// File holding the per-commit filters
+#define CHANGED_PATHS_FILE ".gg/changed-paths"
+
+// Per-commit changed-path filters
+class ChangedPathIndex {
+private:
+    // Commit id -> filter; commits that changed too many paths have no
+    // filter and always answer "maybe"
+    std::unordered_map<std::string, BlockedBloomFilter> filters;
+
+public:
+    static const size_t BITS_PER_PATH = 10;
+    static const size_t PATH_HASHES = 7;
+    static const size_t MAX_CHANGED_PATHS = 512;
+
+    bool load(const std::string& filepath = CHANGED_PATHS_FILE);
+
+    // Compute the filter for a new commit and append it to the file
+    static bool append(const Commit& commit, const std::string& filepath = CHANGED_PATHS_FILE);
+
+    // False only if the commit definitely did not change path, or any file
+    // under it when path is a directory. Commits without a filter (older
+    // than the file) answer true.
+    bool might_change(const std::string& commit_id, const std::string& path) const;
+
+    // Exact check against the commit's snapshot, for filter hits
+    static bool changes(const Commit& commit, const std::string& path);
+
+    size_t size() const;
+};
+
+#endif // PATHINDEX_H
@@ -0,0 +1,59 @@
+/**
+ * reachability.h - Reachability bitmaps for branch tips
+ *
+ * For selected commits (every branch tip, plus every SAMPLE_INTERVAL-th
+ * commit) the set of commits reachable from it is stored as an EWAH bitmap
+ * over commit indices. The bitmap of any other commit is its own short walk
+ * down to the nearest commits that have one, OR'd together, so "is X
+ * reachable from Y" is a bit test and "what does feature have that main
+ * lacks" is an AND-NOT. Bitmaps are kept in .gg/bitmaps.
+ */
+
+#ifndef REACHABILITY_H
+#define REACHABILITY_H
+
+#include "bitmap.h"
+#include "dag.h"
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+
+// Stored reachability bitmaps, keyed by commit index
+class ReachabilityIndex {
+private:
+    std::map<CommitIndex, EWAHBitmap> bitmaps;
+    size_t covered;        // Commits in the DAG when last updated
+    std::string last_id;   // Id of the last of them
+    bool dirty;            // Bitmaps added or dropped since the last save
+
+public:
+    static const CommitIndex SAMPLE_INTERVAL = 256;
+
+    ReachabilityIndex();
+
+    // Add bitmaps for new sample commits and the given tips, and drop those
+    // of commits that are neither any more. An index that does not match
+    // the DAG is rebuilt.
+    void update(const DAG& dag, const std::vector<CommitIndex>& tips);
+
+    // Commits reachable from a commit, itself included
+    EWAHBitmap reachable_from(const DAG& dag, CommitIndex commit) const;
+
+    // Queries
+    bool reaches(const DAG& dag, CommitIndex from, CommitIndex target) const;
+    std::pair<size_t, size_t> ahead_behind(const DAG& dag, CommitIndex ours, CommitIndex theirs) const;
+    static std::pair<size_t, size_t> ahead_behind(const EWAHBitmap& ours, const EWAHBitmap& theirs);
+    std::vector<CommitIndex> difference(const DAG& dag, CommitIndex ours, CommitIndex theirs) const;
+
+    size_t size() const;
+    size_t size_in_bytes() const;
+    bool is_dirty() const;
+    void clear_dirty();
+
+    // Serialization
+    std::string serialize() const;
+    static ReachabilityIndex deserialize(const std::string& data);
+};
+
+#endif // REACHABILITY_H
@@ -0,0 +1,61 @@
+/**
+ * reflog.h - Append-only logs of branch and HEAD movements
+ *
+ * Whenever HEAD or a branch moves, a fixed-size record (old commit, new
+ * commit, time, reason) is appended to its log under .gg/logs. Records are
+ * never rewritten and their times never decrease, so record i sits at a
+ * known offset and "where did main point at noon yesterday" is a binary
+ * search reading O(log n) records instead of a walk of the commit graph.
+ */
+
+#ifndef REFLOG_H
+#define REFLOG_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Directory holding the logs: HEAD, and refs/heads/<branch>
+#define REFLOG_DIR ".gg/logs"
+
+// One movement of a ref
+struct ReflogEntry {
+    std::string old_id; // Empty when the ref was created
+    std::string new_id;
+    int64_t time;       // As parse_timestamp() returns it
+    std::string reason;
+
+    ReflogEntry() : time(0) {}
+};
+
+// The log of one ref
+class Reflog {
+private:
+    std::string path;
+
+public:
+    static const size_t HEADER_SIZE = 8;  // Tag and format version
+    static const size_t ID_SIZE = 32;     // Raw SHA-256 commit id
+    static const size_t REASON_SIZE = 56; // NUL-padded, longer reasons are cut
+    static const size_t RECORD_SIZE = 2 * ID_SIZE + 8 + REASON_SIZE;
+    static const size_t NO_ENTRY = SIZE_MAX;
+
+    explicit Reflog(const std::string& path);
+    static Reflog for_head();
+    static Reflog for_branch(const std::string& branch_name);
+
+    // Record a movement made now
+    bool append(const std::string& old_id, const std::string& new_id, const std::string& reason);
+
+    // Number of complete records
+    size_t size() const;
+
+    // Records [begin, end), read with one seek and one read
+    std::vector<ReflogEntry> read(size_t begin, size_t end) const;
+
+    // Index of the last record made at or before time, or NO_ENTRY
+    size_t find_at(int64_t time) const;
+};
+
+#endif // REFLOG_H
@@ -0,0 +1,60 @@
+/**
+ * refs.h - Packed and loose branch refs
+ *
+ * Every branch is stored in .gg/packed-refs, sorted by name, which is read
+ * with one sequential read and rebuilt into the branch tree in O(n). Saving
+ * does not rewrite that file: each branch created, moved or deleted since
+ * the load is written as a small loose ref under .gg/refs/heads that takes
+ * precedence over its packed entry. Once there are more than MAX_LOOSE_REFS
+ * loose refs they are folded back into the packed file, so a load never
+ * opens more than a bounded number of files however many branches exist.
+ */
+
+#ifndef REFS_H
+#define REFS_H
+
+#include <string>
+#include <set>
+#include <cstddef>
+
+// Files used for branch storage
+#define PACKED_REFS_FILE ".gg/packed-refs"
+#define LOOSE_REFS_DIR ".gg/refs/heads"
+
+class AVLTree;
+
+// File name for a branch's loose ref (and reflog): '/', '.' and '%' are
+// escaped, so every branch maps to one plain file in a flat directory
+std::string escape_ref_name(const std::string& name);
+
+// Reads and writes the branch tree as packed plus loose refs
+class RefStore {
+private:
+    std::string packed_path;
+    std::string loose_dir;
+    std::set<std::string> loose_names; // Branches with a loose ref on disk
+    bool needs_pack;                   // Packed file missing or out of date
+
+    std::string loose_path(const std::string& branch_name) const;
+
+public:
+    // Loose refs allowed before save() folds them into the packed file
+    static const size_t MAX_LOOSE_REFS = 64;
+
+    RefStore(const std::string& packed_path = PACKED_REFS_FILE, const std::string& loose_dir = LOOSE_REFS_DIR);
+
+    // Read the packed refs and apply the loose refs over them
+    AVLTree load();
+
+    // Write the branches changed since load() as loose refs, packing
+    // instead once there would be too many, a name is too long for a file,
+    // or a loose write fails. Returns false if the branches were not saved.
+    bool save(AVLTree& branches);
+
+    // Write every branch to the packed file and delete the loose refs
+    bool pack(AVLTree& branches);
+
+    size_t loose_refs() const;
+};
+
+#endif // REFS_H
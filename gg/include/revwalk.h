@@ -0,0 +1,47 @@
+/**
+ * revwalk.h - Lazy revision walker
+ *
+ * Yields commits newest first, one at a time, starting from any number of
+ * tips. Commits come off a priority queue ordered by generation number and
+ * then date, so every commit is yielded after all of its descendants that
+ * the walk reaches, and only the commits asked for so far (plus the queue
+ * frontier) are ever touched.
+ */
+
+#ifndef REVWALK_H
+#define REVWALK_H
+
+#include "dag.h"
+#include <queue>
+#include <unordered_set>
+#include <vector>
+
+class GenerationIndex;
+
+// Newest-first walk along parent edges
+class RevisionWalker {
+private:
+    struct Order {
+        const GenerationIndex* generations;
+        bool operator()(CommitIndex a, CommitIndex b) const;
+    };
+
+    const DAG& dag;
+    std::priority_queue<CommitIndex, std::vector<CommitIndex>, Order> queue;
+    std::unordered_set<CommitIndex> seen;
+    size_t yielded;
+
+public:
+    RevisionWalker(const DAG& dag, const GenerationIndex& generations);
+
+    // Start the walk (also) from a commit; repeated tips are ignored
+    void push(CommitIndex tip);
+
+    // The next commit, or NO_COMMIT when the walk is exhausted
+    CommitIndex next();
+
+    bool done() const;
+    size_t count() const;
+};
+
+#endif // REVWALK_H
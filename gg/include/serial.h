@@ -0,0 +1,69 @@
+/**
+ * serial.h - Binary encoding for persisted data structures
+ *
+ * Every file under .gg/ starts with a 4-byte magic tag and a format version,
+ * followed by fixed-width little-endian integers and length-prefixed strings.
+ * Files are read with a single sequential read and decoded in place, without
+ * any text parsing.
+ */
+
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Current on-disk format version, bumped on incompatible layout changes
+#define GG_FORMAT_VERSION 1
+
+// Appends encoded values to an in-memory buffer
+class BinaryWriter {
+private:
+    std::string buffer;
+
+public:
+    BinaryWriter() = default;
+
+    void write_header(const char tag[4], uint32_t version = GG_FORMAT_VERSION);
+    void write_u8(uint8_t value);
+    void write_u32(uint32_t value);
+    void write_u64(uint64_t value);
+    void write_string(const std::string& value);
+    void write_bytes(const char* data, size_t length);
+
+    const std::string& data() const { return buffer; }
+};
+
+// Decodes values from a buffer; any out-of-bounds read marks the reader failed
+// and returns zero/empty values from then on
+class BinaryReader {
+private:
+    const std::string& buffer;
+    size_t pos;
+    bool failed;
+
+    bool require(size_t length);
+
+public:
+    BinaryReader(const std::string& data);
+
+    bool read_header(const char tag[4], uint32_t max_version = GG_FORMAT_VERSION);
+    uint8_t read_u8();
+    uint32_t read_u32();
+    uint64_t read_u64();
+    std::string read_string();
+    std::string read_bytes(size_t length);
+
+    bool ok() const { return !failed; }
+    bool at_end() const { return pos >= buffer.size(); }
+};
+
+// Seconds since the epoch for a "YYYY-MM-DD HH:MM:SS" commit or branch
+// timestamp, or 0 if it does not parse
+int64_t parse_timestamp(const std::string& timestamp);
+
+// Inverse of parse_timestamp()
+std::string format_timestamp(int64_t seconds);
+
+#endif // SERIAL_H
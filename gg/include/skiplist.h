@@ -33,6 +33,7 @@ class SkipList {
 private:
     std::shared_ptr<SkipNode> header;
     int level;
+    bool dirty; // Commits inserted since the last save
     std::mt19937 rng;
     std::uniform_real_distribution<double> dist;
     
@@ -48,6 +49,8 @@ public:
     bool insert(const std::string& commit_id, const std::string& timestamp);
     bool search(const std::string& commit_id) const;
     bool remove(const std::string& commit_id);
+    bool is_dirty() const;
+    void clear_dirty();
     
     // Traversal operations
     std::vector<std::string> get_all_commits() const;
@@ -9,9 +9,9 @@
 #define TRIE_H
 
 #include <string>
-#include <map>
-#include <memory>
 #include <vector>
+#include <functional>
+#include <cstddef>
 #include <ncurses.h>
 
 // File status enum
@@ -22,39 +22,56 @@ enum class FileStatus {
     MODIFIED
 };
 
-// Trie node for file paths
-class TrieNode {
-public:
-    std::map<char, std::shared_ptr<TrieNode>> children;
-    bool is_file_end;
-    FileStatus status;
-    
-    TrieNode() : is_file_end(false), status(FileStatus::UNTRACKED) {}
-};
+// Adaptive radix tree node (defined in trie.cpp)
+struct ArtNode;
 
-// Trie for file tracking
+// Trie for file tracking, stored as an adaptive radix tree: runs of bytes
+// shared by all paths below a node are compressed into that node, and inner
+// nodes grow from 4 to 16, 48 and 256 child slots only as their fan-out
+// requires. Each path ends in a leaf holding the full path and its status.
 class Trie {
+public:
+    // Receives each visited path and its status; return false to stop.
+    // The path reference is only valid during the call.
+    typedef std::function<bool(const std::string&, FileStatus)> FileVisitor;
+
 private:
-    std::shared_ptr<TrieNode> root;
-    
-    // Helper functions
-    bool insert_recursive(std::shared_ptr<TrieNode> node, const std::string& path, size_t index, FileStatus status);
-    bool search_recursive(std::shared_ptr<TrieNode> node, const std::string& path, size_t index) const;
-    void get_all_files_recursive(std::shared_ptr<TrieNode> node, std::string current_path, 
-                                std::vector<std::pair<std::string, FileStatus>>& files) const;
-    void draw_recursive(WINDOW* win, std::shared_ptr<TrieNode> node, std::string prefix, 
-                       std::string path, int& y, int x, bool is_last) const;
+    ArtNode* root;
+    size_t file_count;
+    bool dirty;
+
+    bool visit_files(const std::string& prefix, const FileStatus* status, const FileVisitor& visit) const;
 
 public:
     Trie();
+    Trie(const Trie& other);
+    Trie(Trie&& other) noexcept;
+    Trie& operator=(Trie other);
+    ~Trie();
     
     // Core operations
     bool insert(const std::string& path, FileStatus status);
+    bool remove(const std::string& path);
     bool search(const std::string& path) const;
     bool update_status(const std::string& path, FileStatus status);
     FileStatus get_status(const std::string& path) const;
     std::vector<std::pair<std::string, FileStatus>> get_all_files() const;
     std::vector<std::string> get_files_by_status(FileStatus status) const;
+    size_t size() const;
+    
+    // Set by every change and cleared once the change is saved, so the
+    // repository only rewrites structures that changed
+    bool is_dirty() const;
+    void clear_dirty();
+    
+    // Streaming queries in path order, without building a result vector.
+    // Only paths starting with prefix (e.g. "src/net/") are visited, and
+    // the walk ends early when the visitor returns false. Each returns
+    // false if it was stopped.
+    bool for_each_file(const FileVisitor& visit) const;
+    bool for_each_file(const std::string& prefix, const FileVisitor& visit) const;
+    bool for_each_file_with_status(FileStatus status, const FileVisitor& visit,
+                                   const std::string& prefix = "") const;
     
     // Visualization
     void draw(WINDOW* win, int start_y, int start_x) const;
@@ -0,0 +1,68 @@
+/**
+ * walker.h - Parallel work-stealing directory walker
+ *
+ * Walks a directory tree with a pool of threads. Each thread owns a deque of
+ * directories to scan: it pushes and pops subdirectories at the back, and
+ * idle threads steal from the front of other threads' deques, sleeping
+ * when there is nothing to steal until more work is queued. Excluded
+ * directories are pruned before they are opened, and each thread collects
+ * its own results, so no lock is shared by all threads.
+ */
+
+#ifndef WALKER_H
+#define WALKER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+// Parallel directory walker
+class ParallelWalker {
+public:
+    // Receives a path relative to the walk root (no leading "./") and the
+    // index of the calling worker thread, for filters with per-worker state
+    typedef std::function<bool(const std::string&, size_t)> PathFilter;
+
+private:
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::string> dirs;
+    };
+
+    size_t thread_count;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::atomic<size_t> pending; // Directories queued or being scanned
+    std::atomic<size_t> queued;  // Directories queued, not yet taken
+    std::atomic<size_t> idle;    // Workers sleeping on work_available
+    std::mutex idle_lock;
+    std::condition_variable work_available;
+    PathFilter skip_directory;
+    PathFilter report_file;
+
+    // Helper methods
+    void push_directory(size_t worker, const std::string& dir);
+    bool pop_directory(size_t worker, std::string& dir);
+    bool steal_directory(size_t worker, std::string& dir);
+    void scan_directory(size_t worker, const std::string& dir, std::vector<std::string>& found);
+    void worker_loop(size_t worker, std::vector<std::string>& found);
+
+public:
+    ParallelWalker(size_t thread_count = 0);
+
+    size_t get_thread_count() const;
+
+    // Directories for which skip_directory returns true are never opened;
+    // files are reported when report_file returns true (or is unset)
+    void set_directory_filter(PathFilter filter);
+    void set_file_filter(PathFilter filter);
+
+    // Walk the tree under root and return the reported files, sorted
+    std::vector<std::string> walk(const std::string& root);
+};
+
+#endif // WALKER_H
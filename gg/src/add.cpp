@@ -2,12 +2,15 @@
  * add.cpp - Implementation of the 'gg add' command
  * 
  * Stages a file for commit by adding it to the repository's tracking system,
- * updating the Trie and Bloom Filter data structures.
+ * updating the Trie and Cuckoo Filter data structures.
  */
 
 #include "../include/gg.h"
 #include "../include/trie.h"
-#include "../include/bloom.h"
+#include "../include/cuckoo.h"
+#include "../include/objects.h"
+#include "../include/index.h"
+#include "../include/monitor.h"
 #include <iostream>
 #include <filesystem>
 #include <fstream>
@@ -27,6 +30,30 @@ const std::vector<std::string> QuipGenerator::add_quips = {
     "Successfully tracked. Future you will either thank you or curse your name."
 };
 
+// Record a staged file in the Trie, filter and index. The filter only
+// learns new paths, so its item count stays equal to the Trie's size.
+static void stage_path(GGRepo& repo, const std::string& filepath, const std::string& blob_id) {
+    bool tracked = repo.file_trie->search(filepath);
+    repo.file_trie->insert(filepath, FileStatus::STAGED);
+    if (!tracked && (!repo.file_filter->add(filepath) || repo.file_filter->is_full() ||
+                     repo.file_filter->false_positive_probability() > GGRepo::FILE_FILTER_TARGET_FPR)) {
+        repo.rebuild_file_filter(); // Out of room or past the target rate: regrow from the Trie
+    }
+    repo.index->update(filepath, blob_id);
+}
+
+// Forget a tracked file in the Trie, filter and index
+static void unstage_path(GGRepo& repo, const std::string& filepath) {
+    repo.file_trie->remove(filepath);
+    repo.file_filter->remove(filepath);
+    repo.index->remove(filepath);
+    
+    // The monitor's journal never mentions a file that was only untracked,
+    // so drop the cached status and let the next one rescan
+    std::error_code ec;
+    fs::remove(MONITOR_STATUS_FILE, ec);
+}
+
 // Add a file to the staging area
 bool add_file(const std::string& filepath) {
     // Check if we're in a gg repository
@@ -41,9 +68,26 @@ bool add_file(const std::string& filepath) {
         return false;
     }
     
+    // Stream the file contents into the object store
+    std::string blob_id = ObjectStore().write_blob_from_file(filepath);
+    if (blob_id.empty()) {
+        std::cerr << "Error: Could not read '" << filepath << "'" << std::endl;
+        return false;
+    }
+    
     // Load repository state
     GGRepo repo = GGRepo::load();
     
+    // Headless mode: update the data structures and report in plain text
+    if (is_headless_mode()) {
+        stage_path(repo, filepath, blob_id);
+        if (!repo.save()) {
+            return false;
+        }
+        std::cout << "[gg] Staged " << filepath << "." << std::endl;
+        return true;
+    }
+    
     // Initialize UI
     init_ui();
     clear();
@@ -69,16 +113,15 @@ bool add_file(const std::string& filepath) {
     
     row += 9;
     
-    // Draw Bloom Filter before update
-    WINDOW* bloom_before_win = newwin(8, 40, row, col);
-    box(bloom_before_win, 0, 0);
-    mvwprintw(bloom_before_win, 0, 2, " Bloom Filter (Before) ");
-    repo.file_filter->draw(bloom_before_win, 1, 2, 36, 6);
-    wrefresh(bloom_before_win);
+    // Draw Cuckoo Filter before update
+    WINDOW* filter_before_win = newwin(8, 40, row, col);
+    box(filter_before_win, 0, 0);
+    mvwprintw(filter_before_win, 0, 2, " Cuckoo Filter (Before) ");
+    repo.file_filter->draw(filter_before_win, 1, 2, 36, 6);
+    wrefresh(filter_before_win);
     
     // Update the data structures
-    repo.file_trie->insert(filepath, FileStatus::STAGED);
-    repo.file_filter->add(filepath);
+    stage_path(repo, filepath, blob_id);
     
     // Column for "after" panels
     col += 42;
@@ -93,12 +136,12 @@ bool add_file(const std::string& filepath) {
     
     row += 9;
     
-    // Draw Bloom Filter after update
-    WINDOW* bloom_after_win = newwin(8, 40, row, col);
-    box(bloom_after_win, 0, 0);
-    mvwprintw(bloom_after_win, 0, 2, " Bloom Filter (After) ");
-    repo.file_filter->draw(bloom_after_win, 1, 2, 36, 6);
-    wrefresh(bloom_after_win);
+    // Draw Cuckoo Filter after update
+    WINDOW* filter_after_win = newwin(8, 40, row, col);
+    box(filter_after_win, 0, 0);
+    mvwprintw(filter_after_win, 0, 2, " Cuckoo Filter (After) ");
+    repo.file_filter->draw(filter_after_win, 1, 2, 36, 6);
+    wrefresh(filter_after_win);
     
     // Animate the insertion into the Trie
     // (This would be a more complex animation in a real implementation)
@@ -111,7 +154,10 @@ bool add_file(const std::string& filepath) {
     }
     
     // Save repository state
-    repo.save();
+    if (!repo.save()) {
+        cleanup_ui();
+        return false;
+    }
     
     // Display success message and a quip
     attron(COLOR_PAIR(COLOR_SUCCESS));
@@ -127,9 +173,9 @@ bool add_file(const std::string& filepath) {
     
     // Clean up UI
     delwin(trie_before_win);
-    delwin(bloom_before_win);
+    delwin(filter_before_win);
     delwin(trie_after_win);
-    delwin(bloom_after_win);
+    delwin(filter_after_win);
     cleanup_ui();
     
     return true;
@@ -145,3 +191,83 @@ bool add_command(int argc, char* argv[]) {
     
     return add_file(argv[1]);
 }
+
+// Stop tracking a file, deleting it from the working tree unless keep_file
+bool remove_file(const std::string& filepath, bool keep_file) {
+    // Check if we're in a gg repository
+    if (!fs::exists(".gg")) {
+        std::cerr << "Error: Not a gg repository (or any of the parent directories)" << std::endl;
+        return false;
+    }
+    
+    // Load repository state
+    GGRepo repo = GGRepo::load();
+    
+    if (!repo.file_trie->search(filepath)) {
+        std::cerr << "Error: '" << filepath << "' is not tracked" << std::endl;
+        return false;
+    }
+    
+    std::error_code ec;
+    if (!keep_file && fs::exists(filepath) && !fs::remove(filepath, ec)) {
+        std::cerr << "Error: Could not delete '" << filepath << "': " << ec.message() << std::endl;
+        return false;
+    }
+    
+    // Headless mode: update the data structures and report in plain text
+    if (is_headless_mode()) {
+        unstage_path(repo, filepath);
+        if (!repo.save()) {
+            return false;
+        }
+        std::cout << "[gg] Removed " << filepath << "." << std::endl;
+        return true;
+    }
+    
+    // Initialize UI
+    init_ui();
+    clear();
+    
+    // Display header
+    display_header("Removing File from Repository");
+    
+    attron(COLOR_PAIR(COLOR_DEFAULT));
+    mvprintw(2, 2, "File: %s", filepath.c_str());
+    attroff(COLOR_PAIR(COLOR_DEFAULT));
+    
+    // The filter drops the file's fingerprint, so its occupancy goes down
+    WINDOW* filter_before_win = newwin(8, 40, 5, 2);
+    box(filter_before_win, 0, 0);
+    mvwprintw(filter_before_win, 0, 2, " Cuckoo Filter (Before) ");
+    repo.file_filter->draw(filter_before_win, 1, 2, 36, 6);
+    wrefresh(filter_before_win);
+    
+    unstage_path(repo, filepath);
+    
+    WINDOW* filter_after_win = newwin(8, 40, 5, 44);
+    box(filter_after_win, 0, 0);
+    mvwprintw(filter_after_win, 0, 2, " Cuckoo Filter (After) ");
+    repo.file_filter->draw(filter_after_win, 1, 2, 36, 6);
+    wrefresh(filter_after_win);
+    
+    // Save repository state
+    if (!repo.save()) {
+        cleanup_ui();
+        return false;
+    }
+    
+    attron(COLOR_PAIR(COLOR_SUCCESS));
+    mvprintw(15, 2, "[gg] Removed %s.", filepath.c_str());
+    attroff(COLOR_PAIR(COLOR_SUCCESS));
+    
+    // Refresh and wait for user input
+    refresh();
+    getch();
+    
+    // Clean up UI
+    delwin(filter_before_win);
+    delwin(filter_after_win);
+    cleanup_ui();
+    
+    return true;
+}
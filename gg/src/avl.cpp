@@ -0,0 +1,401 @@
+/**
+ * avl.cpp - AVL Tree for branch management
+ *
+ * Insertion and deletion recurse down one root-to-leaf path, which is
+ * O(log n) long, and rebalance each node on the way back up with at most
+ * two rotations. Lookups and in-order traversal are iterative. Deletion
+ * relinks nodes rather than copying branches between them, which keeps
+ * the pointers held by the recency index valid.
+ */
+
+#include "../include/avl.h"
+#include "../include/serial.h"
+#include <algorithm>
+
+// BranchInfo implementation
+BranchInfo::BranchInfo(const std::string& name, const std::string& commit_id,
+                      const std::string& creation_time) {
+    this->name = name;
+    this->commit_id = commit_id;
+    this->creation_time = creation_time;
+    this->latest_commit_time = creation_time;
+    this->commit_time = parse_timestamp(creation_time);
+}
+
+bool RecencyOrder::operator()(const BranchInfo* a, const BranchInfo* b) const {
+    if (a->commit_time != b->commit_time) {
+        return a->commit_time < b->commit_time;
+    }
+    return a->name < b->name;
+}
+
+// AVLNode implementation
+AVLNode::AVLNode(const BranchInfo& branch) {
+    this->branch = branch;
+    this->height = 1;
+    this->left = nullptr;
+    this->right = nullptr;
+}
+
+int AVLNode::balance_factor() const {
+    int left_height = left ? left->height : 0;
+    int right_height = right ? right->height : 0;
+    return left_height - right_height;
+}
+
+// AVLTree implementation
+AVLTree::AVLTree() : root(nullptr), branch_count(0) {}
+
+int AVLTree::height(const std::shared_ptr<AVLNode>& node) const {
+    return node ? node->height : 0;
+}
+
+void AVLTree::update_height(const std::shared_ptr<AVLNode>& node) {
+    node->height = 1 + std::max(height(node->left), height(node->right));
+}
+
+// Lift y's left child x into y's place; x's right subtree moves under y
+std::shared_ptr<AVLNode> AVLTree::right_rotate(std::shared_ptr<AVLNode> y) {
+    std::shared_ptr<AVLNode> x = y->left;
+    y->left = x->right;
+    x->right = y;
+    update_height(y);
+    update_height(x);
+    return x;
+}
+
+// Mirror image of right_rotate
+std::shared_ptr<AVLNode> AVLTree::left_rotate(std::shared_ptr<AVLNode> x) {
+    std::shared_ptr<AVLNode> y = x->right;
+    x->right = y->left;
+    y->left = x;
+    update_height(x);
+    update_height(y);
+    return y;
+}
+
+// Restore the AVL invariant at a node whose subtrees are balanced but may
+// differ in height by two
+std::shared_ptr<AVLNode> AVLTree::rebalance(std::shared_ptr<AVLNode> node) {
+    update_height(node);
+    int balance = node->balance_factor();
+
+    if (balance > 1) {
+        // Left-right case: straighten the left child first
+        if (node->left->balance_factor() < 0) {
+            node->left = left_rotate(node->left);
+        }
+        return right_rotate(node);
+    }
+    if (balance < -1) {
+        // Right-left case
+        if (node->right->balance_factor() > 0) {
+            node->right = right_rotate(node->right);
+        }
+        return left_rotate(node);
+    }
+    return node;
+}
+
+bool AVLTree::insert(const BranchInfo& branch) {
+    bool inserted = false;
+    root = insert_node(root, branch, inserted);
+    if (!inserted) {
+        return false;
+    }
+
+    branch_count++;
+    commit_branches[branch.commit_id].insert(branch.name);
+    recency.insert(&find_node(branch.name)->branch);
+    changed.insert(branch.name);
+    return true;
+}
+
+std::shared_ptr<AVLNode> AVLTree::insert_node(std::shared_ptr<AVLNode> node, const BranchInfo& branch, bool& inserted) {
+    if (!node) {
+        inserted = true;
+        return std::make_shared<AVLNode>(branch);
+    }
+
+    if (branch.name < node->branch.name) {
+        node->left = insert_node(node->left, branch, inserted);
+    } else if (branch.name > node->branch.name) {
+        node->right = insert_node(node->right, branch, inserted);
+    } else {
+        return node; // Duplicate name
+    }
+
+    return inserted ? rebalance(node) : node;
+}
+
+bool AVLTree::remove(const std::string& branch_name) {
+    AVLNode* node = find_node(branch_name);
+    if (!node) {
+        return false;
+    }
+
+    unlink_commit(node->branch.commit_id, branch_name);
+    recency.erase(&node->branch);
+    bool removed = false;
+    root = delete_node(root, branch_name, removed);
+    branch_count--;
+    changed.insert(branch_name);
+    return true;
+}
+
+std::shared_ptr<AVLNode> AVLTree::delete_node(std::shared_ptr<AVLNode> node, const std::string& branch_name, bool& removed) {
+    if (!node) {
+        return node;
+    }
+
+    if (branch_name < node->branch.name) {
+        node->left = delete_node(node->left, branch_name, removed);
+    } else if (branch_name > node->branch.name) {
+        node->right = delete_node(node->right, branch_name, removed);
+    } else if (!node->left || !node->right) {
+        removed = true;
+        return node->left ? node->left : node->right;
+    } else {
+        // Two children: the successor's node takes this node's place, so
+        // branches never move between nodes
+        std::shared_ptr<AVLNode> successor;
+        std::shared_ptr<AVLNode> right = detach_min(node->right, successor);
+        successor->left = node->left;
+        successor->right = right;
+        removed = true;
+        return rebalance(successor);
+    }
+
+    return removed ? rebalance(node) : node;
+}
+
+// Unlink the leftmost node of a non-empty subtree into min
+std::shared_ptr<AVLNode> AVLTree::detach_min(std::shared_ptr<AVLNode> node, std::shared_ptr<AVLNode>& min) {
+    if (!node->left) {
+        min = node;
+        return node->right;
+    }
+    node->left = detach_min(node->left, min);
+    return rebalance(node);
+}
+
+AVLNode* AVLTree::find_node(const std::string& branch_name) const {
+    AVLNode* node = root.get();
+    while (node) {
+        int cmp = branch_name.compare(node->branch.name);
+        if (cmp == 0) {
+            return node;
+        }
+        node = cmp < 0 ? node->left.get() : node->right.get();
+    }
+    return nullptr;
+}
+
+BranchInfo* AVLTree::find(const std::string& branch_name) const {
+    AVLNode* node = find_node(branch_name);
+    return node ? &node->branch : nullptr;
+}
+
+bool AVLTree::update_commit(const std::string& branch_name, const std::string& commit_id,
+                          const std::string& commit_time) {
+    BranchInfo* branch = find(branch_name);
+    if (!branch) {
+        return false;
+    }
+
+    unlink_commit(branch->commit_id, branch_name);
+    commit_branches[commit_id].insert(branch_name);
+    recency.erase(branch);
+    branch->commit_id = commit_id;
+    branch->latest_commit_time = commit_time;
+    branch->commit_time = parse_timestamp(commit_time);
+    recency.insert(branch);
+    changed.insert(branch_name);
+    return true;
+}
+
+// Branches often share a commit (every new branch starts at HEAD), so
+// each commit keeps a sorted set rather than a list to scan
+void AVLTree::unlink_commit(const std::string& commit_id, const std::string& branch_name) {
+    auto it = commit_branches.find(commit_id);
+    if (it == commit_branches.end()) {
+        return;
+    }
+    it->second.erase(branch_name);
+    if (it->second.empty()) {
+        commit_branches.erase(it);
+    }
+}
+
+std::vector<std::string> AVLTree::branches_at(const std::string& commit_id) const {
+    auto it = commit_branches.find(commit_id);
+    if (it == commit_branches.end()) {
+        return {};
+    }
+    return std::vector<std::string>(it->second.begin(), it->second.end());
+}
+
+std::vector<std::string> AVLTree::get_branch_commits() const {
+    std::vector<std::string> commits;
+    commits.reserve(commit_branches.size());
+    for (const auto& [commit_id, names] : commit_branches) {
+        commits.push_back(commit_id);
+    }
+    return commits;
+}
+
+std::vector<BranchInfo> AVLTree::get_all_branches() const {
+    std::vector<BranchInfo> branches;
+    branches.reserve(branch_count);
+    in_order_traversal(root, branches);
+    return branches;
+}
+
+void AVLTree::in_order_traversal(const std::shared_ptr<AVLNode>& node, std::vector<BranchInfo>& branches) const {
+    // Explicit stack of the left spine; at most the tree height deep
+    std::vector<AVLNode*> stack;
+    AVLNode* current = node.get();
+    while (current || !stack.empty()) {
+        while (current) {
+            stack.push_back(current);
+            current = current->left.get();
+        }
+        current = stack.back();
+        stack.pop_back();
+        branches.push_back(current->branch);
+        current = current->right.get();
+    }
+}
+
+void AVLTree::scan_from(const std::string& from, const std::function<bool(const BranchInfo&)>& visit) const {
+    // Lower bound descent: the stack holds every node >= from on the way
+    // down, so it ends up exactly as an in-order walk would have it
+    std::vector<AVLNode*> stack;
+    AVLNode* current = root.get();
+    while (current) {
+        if (current->branch.name < from) {
+            current = current->right.get();
+        } else {
+            stack.push_back(current);
+            current = current->left.get();
+        }
+    }
+
+    while (!stack.empty()) {
+        current = stack.back();
+        stack.pop_back();
+        if (!visit(current->branch)) {
+            return;
+        }
+        for (current = current->right.get(); current; current = current->left.get()) {
+            stack.push_back(current);
+        }
+    }
+}
+
+void AVLTree::scan_by_time(bool newest_first, const std::function<bool(const BranchInfo&)>& visit) const {
+    if (newest_first) {
+        for (auto it = recency.rbegin(); it != recency.rend(); ++it) {
+            if (!visit(**it)) return;
+        }
+    } else {
+        for (const BranchInfo* branch : recency) {
+            if (!visit(*branch)) return;
+        }
+    }
+}
+
+size_t AVLTree::size() const {
+    return branch_count;
+}
+
+int AVLTree::get_height() const {
+    return height(root);
+}
+
+const std::set<std::string>& AVLTree::changed_branches() const {
+    return changed;
+}
+
+void AVLTree::clear_changed() {
+    changed.clear();
+}
+
+void AVLTree::draw(WINDOW* win, int start_y, int start_x, const std::string& current_branch) const {
+    // Stub implementation - does nothing in non-ncurses mode
+    (void)win;
+    (void)start_y;
+    (void)start_x;
+    (void)current_branch;
+}
+
+std::string AVLTree::serialize() const {
+    std::vector<BranchInfo> branches = get_all_branches();
+
+    BinaryWriter writer;
+    writer.write_header("GGAV");
+    writer.write_u32(static_cast<uint32_t>(branches.size()));
+    for (const auto& branch : branches) {
+        writer.write_string(branch.name);
+        writer.write_string(branch.commit_id);
+        writer.write_string(branch.creation_time);
+        writer.write_string(branch.latest_commit_time);
+    }
+    return writer.data();
+}
+
+// Make the middle of a sorted range the root and build both halves the
+// same way; sibling subtrees then differ in size by at most one
+std::shared_ptr<AVLNode> AVLTree::build_sorted(const std::vector<BranchInfo>& branches, size_t begin, size_t end) {
+    if (begin == end) {
+        return nullptr;
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+    std::shared_ptr<AVLNode> node = std::make_shared<AVLNode>(branches[middle]);
+    node->left = build_sorted(branches, begin, middle);
+    node->right = build_sorted(branches, middle + 1, end);
+    update_height(node);
+
+    commit_branches[node->branch.commit_id].insert(node->branch.name);
+    recency.insert(&node->branch);
+    return node;
+}
+
+AVLTree AVLTree::deserialize(const std::string& data) {
+    AVLTree tree;
+    BinaryReader reader(data);
+    if (!reader.read_header("GGAV")) {
+        return tree;
+    }
+
+    uint32_t count = reader.read_u32();
+    std::vector<BranchInfo> branches;
+    branches.reserve(std::min<size_t>(count, data.size() / 16));
+    bool sorted = true;
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        BranchInfo branch;
+        branch.name = reader.read_string();
+        branch.commit_id = reader.read_string();
+        branch.creation_time = reader.read_string();
+        branch.latest_commit_time = reader.read_string();
+        branch.commit_time = parse_timestamp(branch.latest_commit_time);
+        if (reader.ok()) {
+            sorted = sorted && (branches.empty() || branches.back().name < branch.name);
+            branches.push_back(branch);
+        }
+    }
+
+    // serialize() always writes names in order; anything else is inserted
+    // one by one, which also drops duplicates
+    if (sorted) {
+        tree.root = tree.build_sorted(branches, 0, branches.size());
+        tree.branch_count = branches.size();
+    } else {
+        for (const auto& branch : branches) {
+            tree.insert(branch);
+        }
+        tree.clear_changed();
+    }
+    return tree;
+}
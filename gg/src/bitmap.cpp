@@ -0,0 +1,288 @@
+/**
+ * bitmap.cpp - EWAH compressed bitmaps
+ *
+ * Marker layout, low bit first: fill bit (1), run length in words (32),
+ * literal word count (31). A bitmap is a sequence of markers, each followed
+ * by its literal words; words past the end of the sequence are zero.
+ */
+
+#include "../include/bitmap.h"
+#include "../include/serial.h"
+#include <algorithm>
+
+static const uint64_t ALL_ONES = ~0ULL;
+
+static uint64_t marker_run(uint64_t marker) { return (marker >> 1) & EWAHBitmap::MAX_RUN; }
+static uint64_t marker_literals(uint64_t marker) { return marker >> 33; }
+static bool marker_bit(uint64_t marker) { return (marker & 1) != 0; }
+static uint64_t make_marker(bool bit, uint64_t run, uint64_t literals) {
+    return (bit ? 1ULL : 0ULL) | (run << 1) | (literals << 33);
+}
+
+// Reads a bitmap back as runs and literal words
+namespace {
+struct WordCursor {
+    const std::vector<uint64_t>& words;
+    size_t next = 0;           // Next marker or literal word
+    uint64_t run_left = 0;
+    uint64_t literals_left = 0;
+    bool run_bit = false;
+
+    explicit WordCursor(const std::vector<uint64_t>& words) : words(words) {}
+
+    // Load markers until there is something to read; past the end the
+    // cursor reads as an endless run of zeros
+    void load() {
+        while (run_left == 0 && literals_left == 0 && next < words.size()) {
+            uint64_t marker = words[next++];
+            run_bit = marker_bit(marker);
+            run_left = marker_run(marker);
+            literals_left = marker_literals(marker);
+        }
+        if (run_left == 0 && literals_left == 0) {
+            run_bit = false;
+            run_left = UINT64_MAX;
+        }
+    }
+
+    bool in_run() const { return run_left > 0; }
+    uint64_t fill_word() const { return run_bit ? ALL_ONES : 0; }
+
+    uint64_t take_word() {
+        if (run_left > 0) {
+            run_left--;
+            return fill_word();
+        }
+        literals_left--;
+        return words[next++];
+    }
+};
+}
+
+// EWAHBitmap implementation
+EWAHBitmap::EWAHBitmap() : last_marker(0), bit_count(0) {}
+
+void EWAHBitmap::add_fill(bool bit, uint64_t count) {
+    while (count > 0) {
+        // Extend the current marker while it has no literals after it
+        if (!words.empty()) {
+            uint64_t marker = words[last_marker];
+            uint64_t run = marker_run(marker);
+            if (marker_literals(marker) == 0 && (run == 0 || marker_bit(marker) == bit) && run < MAX_RUN) {
+                uint64_t added = std::min(count, MAX_RUN - run);
+                words[last_marker] = make_marker(bit, run + added, 0);
+                count -= added;
+                continue;
+            }
+        }
+        last_marker = words.size();
+        words.push_back(make_marker(bit, 0, 0));
+    }
+}
+
+void EWAHBitmap::add_literal(uint64_t word) {
+    if (words.empty() || marker_literals(words[last_marker]) == MAX_LITERALS) {
+        last_marker = words.size();
+        words.push_back(make_marker(false, 0, 0));
+    }
+    words[last_marker] += 1ULL << 33;
+    words.push_back(word);
+}
+
+void EWAHBitmap::add_word(uint64_t word) {
+    if (word == 0 || word == ALL_ONES) {
+        add_fill(word != 0, 1);
+    } else {
+        add_literal(word);
+    }
+}
+
+EWAHBitmap EWAHBitmap::from_words(const std::vector<uint64_t>& dense, size_t bits) {
+    EWAHBitmap bitmap;
+    size_t word_count = std::min(dense.size(), (bits + 63) / 64);
+    for (size_t i = 0; i < word_count; ++i) {
+        uint64_t word = dense[i];
+        if (i == word_count - 1 && bits % 64 != 0) {
+            word &= (1ULL << (bits % 64)) - 1; // Never set bits past the end
+        }
+        bitmap.add_word(word);
+    }
+    bitmap.bit_count = bits;
+    return bitmap;
+}
+
+bool EWAHBitmap::get(size_t bit) const {
+    if (bit >= bit_count) {
+        return false;
+    }
+
+    uint64_t target = bit / 64;
+    uint64_t position = 0;
+    size_t i = 0;
+    while (i < words.size()) {
+        uint64_t marker = words[i++];
+        uint64_t run = marker_run(marker);
+        if (target < position + run) {
+            return marker_bit(marker);
+        }
+        position += run;
+        uint64_t literals = marker_literals(marker);
+        if (target < position + literals) {
+            return (words[i + (target - position)] >> (bit % 64)) & 1;
+        }
+        position += literals;
+        i += literals;
+    }
+    return false;
+}
+
+size_t EWAHBitmap::count() const {
+    size_t total = 0;
+    size_t i = 0;
+    while (i < words.size()) {
+        uint64_t marker = words[i++];
+        if (marker_bit(marker)) {
+            total += marker_run(marker) * 64;
+        }
+        uint64_t literals = marker_literals(marker);
+        for (uint64_t l = 0; l < literals; ++l) {
+            total += __builtin_popcountll(words[i++]);
+        }
+    }
+    return total;
+}
+
+size_t EWAHBitmap::size_in_bits() const {
+    return bit_count;
+}
+
+size_t EWAHBitmap::size_in_bytes() const {
+    return words.size() * sizeof(uint64_t);
+}
+
+template <typename Op>
+EWAHBitmap EWAHBitmap::combine(const EWAHBitmap& other, Op op) const {
+    EWAHBitmap result;
+    WordCursor a(words);
+    WordCursor b(other.words);
+    uint64_t remaining = (std::max(bit_count, other.bit_count) + 63) / 64;
+
+    while (remaining > 0) {
+        a.load();
+        b.load();
+        if (a.in_run() && b.in_run()) {
+            // Two runs combine into one run without looking at each word
+            uint64_t length = std::min({a.run_left, b.run_left, remaining});
+            uint64_t word = op(a.fill_word(), b.fill_word());
+            result.add_fill(word != 0, length);
+            a.run_left -= length;
+            b.run_left -= length;
+            remaining -= length;
+        } else {
+            result.add_word(op(a.take_word(), b.take_word()));
+            remaining--;
+        }
+    }
+
+    result.bit_count = std::max(bit_count, other.bit_count);
+    return result;
+}
+
+EWAHBitmap EWAHBitmap::logical_and(const EWAHBitmap& other) const {
+    return combine(other, [](uint64_t x, uint64_t y) { return x & y; });
+}
+
+EWAHBitmap EWAHBitmap::logical_or(const EWAHBitmap& other) const {
+    return combine(other, [](uint64_t x, uint64_t y) { return x | y; });
+}
+
+EWAHBitmap EWAHBitmap::logical_andnot(const EWAHBitmap& other) const {
+    return combine(other, [](uint64_t x, uint64_t y) { return x & ~y; });
+}
+
+void EWAHBitmap::or_into(std::vector<uint64_t>& dense) const {
+    size_t position = 0;
+    size_t i = 0;
+    while (i < words.size()) {
+        uint64_t marker = words[i++];
+        uint64_t run = marker_run(marker);
+        if (marker_bit(marker)) {
+            size_t end = std::min<size_t>(position + run, dense.size());
+            std::fill(dense.begin() + std::min(position, end), dense.begin() + end, ALL_ONES);
+        }
+        position += run;
+        uint64_t literals = marker_literals(marker);
+        for (uint64_t l = 0; l < literals; ++l, ++position, ++i) {
+            if (position < dense.size()) {
+                dense[position] |= words[i];
+            }
+        }
+    }
+}
+
+void EWAHBitmap::for_each(const std::function<bool(size_t)>& visitor) const {
+    size_t position = 0;
+    size_t i = 0;
+    while (i < words.size()) {
+        uint64_t marker = words[i++];
+        uint64_t run = marker_run(marker);
+        if (marker_bit(marker)) {
+            for (size_t bit = position * 64; bit < (position + run) * 64; ++bit) {
+                if (!visitor(bit)) return;
+            }
+        }
+        position += run;
+        uint64_t literals = marker_literals(marker);
+        for (uint64_t l = 0; l < literals; ++l, ++position) {
+            for (uint64_t word = words[i++]; word != 0; word &= word - 1) {
+                if (!visitor(position * 64 + __builtin_ctzll(word))) return;
+            }
+        }
+    }
+}
+
+std::string EWAHBitmap::serialize() const {
+    BinaryWriter writer;
+    writer.write_u64(bit_count);
+    writer.write_u32(static_cast<uint32_t>(words.size()));
+    for (uint64_t word : words) {
+        writer.write_u64(word);
+    }
+    return writer.data();
+}
+
+EWAHBitmap EWAHBitmap::deserialize(const std::string& data) {
+    EWAHBitmap bitmap;
+    BinaryReader reader(data);
+    uint64_t bits = reader.read_u64();
+    uint32_t count = reader.read_u32();
+    if (!reader.ok() || count > data.size() / 8) {
+        return bitmap;
+    }
+
+    std::vector<uint64_t> words;
+    words.reserve(count);
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        words.push_back(reader.read_u64());
+    }
+    if (!reader.ok()) {
+        return bitmap;
+    }
+
+    // Find the last marker so the bitmap can keep growing, and reject
+    // markers that claim more literal words than there are
+    size_t i = 0;
+    size_t last_marker = 0;
+    while (i < words.size()) {
+        last_marker = i;
+        i += 1 + marker_literals(words[i]);
+    }
+    if (i != words.size()) {
+        return bitmap;
+    }
+
+    bitmap.words.swap(words);
+    bitmap.last_marker = last_marker;
+    bitmap.bit_count = bits;
+    return bitmap;
+}
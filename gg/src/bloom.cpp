@@ -0,0 +1,180 @@
+/**
+ * bloom.cpp - Cache-line-blocked Bloom filter
+ *
+ * A key's 64-bit hash is split in two: the high half picks the block, and
+ * the low half is multiplied by k different odd salts, the top 9 bits of
+ * each product giving one in-block bit position. The k bits are assembled
+ * into a 512-bit mask and compared against the block with SIMD loads.
+ */
+
+#include "../include/bloom.h"
+#include "../include/hash.h"
+#include "../include/serial.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static const size_t WORDS_PER_BLOCK = BlockedBloomFilter::BLOCK_BITS / 64;
+
+// Odd multipliers for the in-block positions. Plain double hashing
+// (h1 + i*h2) makes masks of nearby keys overlap within a 512-bit block
+// and measurably raises the false-positive rate.
+static const uint32_t BIT_SALTS[BlockedBloomFilter::MAX_HASHES] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+    0x9e3779b1U, 0x85ebca77U, 0xc2b2ae3dU, 0x27d4eb2fU,
+    0x165667b1U, 0xd3a2646dU, 0xfd7046c5U, 0xb55a4f09U
+};
+
+// BlockedBloomFilter implementation
+BlockedBloomFilter::BlockedBloomFilter(size_t size, size_t hash_count) {
+    size_t block_count = std::max<size_t>(1, (size + BLOCK_BITS - 1) / BLOCK_BITS);
+    blocks.assign(block_count, Block{});
+    this->hash_count = std::min(std::max<size_t>(1, hash_count), MAX_HASHES);
+    item_count = 0;
+    bits_set = 0;
+}
+
+size_t BlockedBloomFilter::block_for(uint64_t hash) const {
+    // Multiply-shift maps the high 32 bits onto [0, blocks) without a divide
+    return static_cast<size_t>(((hash >> 32) * blocks.size()) >> 32);
+}
+
+void BlockedBloomFilter::make_mask(uint64_t hash, uint64_t mask[WORDS_PER_BLOCK]) const {
+    std::memset(mask, 0, WORDS_PER_BLOCK * sizeof(uint64_t));
+    uint32_t low = static_cast<uint32_t>(hash);
+    for (size_t i = 0; i < hash_count; ++i) {
+        uint32_t bit = (low * BIT_SALTS[i]) >> 23; // Top 9 bits: 0..511
+        mask[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+void BlockedBloomFilter::add(const std::string& item) {
+    uint64_t hash = hash64(item);
+    uint64_t mask[WORDS_PER_BLOCK];
+    make_mask(hash, mask);
+
+    Block& block = blocks[block_for(hash)];
+    for (size_t w = 0; w < WORDS_PER_BLOCK; ++w) {
+        bits_set += __builtin_popcountll(mask[w] & ~block.words[w]);
+        block.words[w] |= mask[w];
+    }
+    item_count++;
+}
+
+bool BlockedBloomFilter::might_contain(const std::string& item) const {
+    uint64_t hash = hash64(item);
+    const Block& block = blocks[block_for(hash)];
+    alignas(16) uint64_t mask[WORDS_PER_BLOCK];
+    make_mask(hash, mask);
+
+#if defined(__SSE2__)
+    // (block & mask) == mask, 128 bits at a time
+    __m128i missing = _mm_setzero_si128();
+    for (size_t w = 0; w < WORDS_PER_BLOCK; w += 2) {
+        __m128i m = _mm_load_si128(reinterpret_cast<const __m128i*>(&mask[w]));
+        __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(&block.words[w]));
+        missing = _mm_or_si128(missing, _mm_andnot_si128(b, m));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xffff;
+#else
+    uint64_t missing = 0;
+    for (size_t w = 0; w < WORDS_PER_BLOCK; ++w) {
+        missing |= mask[w] & ~block.words[w];
+    }
+    return missing == 0;
+#endif
+}
+
+void BlockedBloomFilter::clear() {
+    std::fill(blocks.begin(), blocks.end(), Block{});
+    item_count = 0;
+    bits_set = 0;
+}
+
+double BlockedBloomFilter::false_positive_probability() const {
+    // A random key picks a block uniformly, then needs all k of its bits
+    // set there: average fill^k over the blocks
+    if (bits_set == 0) {
+        return 0.0;
+    }
+    double sum = 0;
+    for (const Block& block : blocks) {
+        size_t set = 0;
+        for (uint64_t word : block.words) {
+            set += __builtin_popcountll(word);
+        }
+        sum += std::pow(static_cast<double>(set) / BLOCK_BITS, static_cast<double>(hash_count));
+    }
+    return sum / blocks.size();
+}
+
+size_t BlockedBloomFilter::get_item_count() const {
+    return item_count;
+}
+
+size_t BlockedBloomFilter::get_size() const {
+    return blocks.size() * BLOCK_BITS;
+}
+
+size_t BlockedBloomFilter::get_hash_count() const {
+    return hash_count;
+}
+
+void BlockedBloomFilter::draw(WINDOW* win, int start_y, int start_x, int width, int height) const {
+    // One cell per bit of the first blocks: '1' set, '.' clear
+    size_t cells = std::min(static_cast<size_t>(std::max(0, width * height)), get_size());
+    for (size_t i = 0; i < cells; ++i) {
+        const Block& block = blocks[i / BLOCK_BITS];
+        size_t bit = i % BLOCK_BITS;
+        bool set = (block.words[bit / 64] >> (bit % 64)) & 1;
+        mvwaddch(win, start_y + static_cast<int>(i) / width, start_x + static_cast<int>(i) % width, set ? '1' : '.');
+    }
+}
+
+std::string BlockedBloomFilter::serialize() const {
+    BinaryWriter writer;
+    writer.write_header("GGBB");
+    writer.write_u64(blocks.size());
+    writer.write_u32(static_cast<uint32_t>(hash_count));
+    writer.write_u64(item_count);
+    writer.write_u64(bits_set);
+    for (const Block& block : blocks) {
+        for (uint64_t word : block.words) {
+            writer.write_u64(word);
+        }
+    }
+    return writer.data();
+}
+
+BlockedBloomFilter BlockedBloomFilter::deserialize(const std::string& data) {
+    BinaryReader reader(data);
+    if (!reader.read_header("GGBB")) {
+        return BlockedBloomFilter();
+    }
+
+    uint64_t block_count = reader.read_u64();
+    uint32_t hashes = reader.read_u32();
+    uint64_t items = reader.read_u64();
+    uint64_t set = reader.read_u64();
+    if (!reader.ok() || block_count == 0 || block_count > (data.size() / 64)) {
+        return BlockedBloomFilter();
+    }
+
+    BlockedBloomFilter filter(block_count * BLOCK_BITS, hashes);
+    for (Block& block : filter.blocks) {
+        for (uint64_t& word : block.words) {
+            word = reader.read_u64();
+        }
+    }
+    if (!reader.ok()) {
+        return BlockedBloomFilter();
+    }
+    filter.item_count = items;
+    filter.bits_set = set;
+    return filter;
+}
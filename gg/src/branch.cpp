@@ -7,10 +7,17 @@
 
 #include "../include/gg.h"
 #include "../include/avl.h"
+#include "../include/refs.h"
 #include "../include/dag.h"
+#include "../include/reachability.h"
 #include <iostream>
 #include <filesystem>
 #include <vector>
+#include <functional>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <limits>
 #include <ncurses.h>
 
 namespace fs = std::filesystem;
@@ -44,6 +51,17 @@ bool create_branch(const std::string& branch_name) {
         return false;
     }
     
+    // Headless mode: insert the branch and report in plain text
+    if (is_headless_mode()) {
+        repo.branches->insert(BranchInfo(branch_name, repo.head_commit, get_current_time_string()));
+        repo.log_branch_move(branch_name, "", repo.head_commit, "branch: Created from " + repo.current_branch);
+        if (!repo.save()) {
+            return false;
+        }
+        std::cout << "[gg] Created branch '" << branch_name << "'" << std::endl;
+        return true;
+    }
+    
     // Initialize UI
     init_ui();
     clear();
@@ -98,6 +116,7 @@ bool create_branch(const std::string& branch_name) {
     
     // Actually insert the branch
     repo.branches->insert(new_branch);
+    repo.log_branch_move(branch_name, "", repo.head_commit, "branch: Created from " + repo.current_branch);
     
     // Draw the AVL tree after modification
     WINDOW* avl_after_win = newwin(15, 50, 5, 55);
@@ -107,7 +126,10 @@ bool create_branch(const std::string& branch_name) {
     wrefresh(avl_after_win);
     
     // Save repository state
-    repo.save();
+    if (!repo.save()) {
+        cleanup_ui();
+        return false;
+    }
     
     // Display success message and quip
     attron(COLOR_PAIR(COLOR_SUCCESS));
@@ -148,6 +170,21 @@ bool switch_branch(const std::string& branch_name) {
         return false;
     }
     
+    // Every checkout is recorded in HEAD's reflog
+    repo.log_head_move(repo.head_commit, branch->commit_id,
+                       "checkout: moving from " + repo.current_branch + " to " + branch_name);
+    
+    // Headless mode: move HEAD and report in plain text
+    if (is_headless_mode()) {
+        repo.current_branch = branch_name;
+        repo.head_commit = branch->commit_id;
+        if (!repo.save()) {
+            return false;
+        }
+        std::cout << "[gg] Switched to branch '" << branch_name << "'" << std::endl;
+        return true;
+    }
+    
     // Initialize UI
     init_ui();
     clear();
@@ -180,7 +217,10 @@ bool switch_branch(const std::string& branch_name) {
     wrefresh(dag_win);
     
     // Save repository state
-    repo.save();
+    if (!repo.save()) {
+        cleanup_ui();
+        return false;
+    }
     
     // Display success message
     attron(COLOR_PAIR(COLOR_SUCCESS));
@@ -200,7 +240,7 @@ bool switch_branch(const std::string& branch_name) {
 }
 
 // List all branches
-void list_branches() {
+void list_branches(const std::string& contains) {
     // Check if we're in a gg repository
     if (!fs::exists(".gg")) {
         std::cerr << "Error: Not a gg repository (or any of the parent directories)" << std::endl;
@@ -209,9 +249,55 @@ void list_branches() {
     
     // Load repository state
     GGRepo repo = GGRepo::load();
+    const DAG& graph = *repo.commit_graph;
     
-    // Get all branches
+    // Get all branches, or only those whose history contains a commit
     std::vector<BranchInfo> branches = repo.branches->get_all_branches();
+    if (!contains.empty()) {
+        CommitIndex target = graph.find(contains);
+        if (target == NO_COMMIT) {
+            std::cerr << "Error: Unknown commit '" << contains << "'" << std::endl;
+            return;
+        }
+        
+        std::vector<BranchInfo> matching;
+        for (const auto& branch : branches) {
+            if (repo.reachability->reaches(graph, graph.find(branch.commit_id), target)) {
+                matching.push_back(branch);
+            }
+        }
+        branches.swap(matching);
+    }
+    
+    // How far each branch has diverged from the current one, from the
+    // reachability bitmaps of the two tips; the current tip's is shared
+    CommitIndex current_tip = graph.find(repo.head_commit);
+    EWAHBitmap current_commits = repo.reachability->reachable_from(graph, current_tip);
+    auto divergence = [&](const BranchInfo& branch) {
+        CommitIndex tip = graph.find(branch.commit_id);
+        if (branch.name == repo.current_branch || tip == NO_COMMIT || current_tip == NO_COMMIT) {
+            return std::string();
+        }
+        auto [ahead, behind] = ReachabilityIndex::ahead_behind(
+            repo.reachability->reachable_from(graph, tip), current_commits);
+        if (ahead == 0 && behind == 0) {
+            return std::string();
+        }
+        std::string text = " [";
+        if (ahead > 0) text += "ahead " + std::to_string(ahead);
+        if (ahead > 0 && behind > 0) text += ", ";
+        if (behind > 0) text += "behind " + std::to_string(behind);
+        return text + "]";
+    };
+    
+    // Headless mode: one branch per line, current branch marked with '*'
+    if (is_headless_mode()) {
+        for (const auto& branch : branches) {
+            std::cout << (branch.name == repo.current_branch ? "* " : "  ")
+                      << branch.name << " " << branch.commit_id << divergence(branch) << std::endl;
+        }
+        return;
+    }
     
     // Initialize UI
     init_ui();
@@ -240,7 +326,7 @@ void list_branches() {
             attroff(COLOR_PAIR(COLOR_HIGHLIGHT));
         } else {
             attron(COLOR_PAIR(COLOR_BRANCH));
-            mvprintw(row++, 4, "  %s (%s)", branch.name.c_str(), branch.commit_id.c_str());
+            mvprintw(row++, 4, "  %s (%s)%s", branch.name.c_str(), branch.commit_id.c_str(), divergence(branch).c_str());
             attroff(COLOR_PAIR(COLOR_BRANCH));
         }
     }
@@ -259,6 +345,241 @@ void list_branches() {
     cleanup_ui();
 }
 
+// Glob match for branch names: '*' matches any run of characters
+// (including '/'), '?' any one character, '[...]' one of a set
+static bool branch_glob_match(const char* pattern, const char* name) {
+    const char* star = nullptr;
+    const char* resume = nullptr;
+    while (*name) {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = name;
+            continue;
+        }
+        if (*pattern == '[') {
+            const char* p = pattern + 1;
+            bool negate = (*p == '!' || *p == '^');
+            if (negate) p++;
+            bool found = false;
+            for (bool first = true; *p && (first || *p != ']'); first = false, p++) {
+                if (p[1] == '-' && p[2] && p[2] != ']') {
+                    found |= (*name >= p[0] && *name <= p[2]);
+                    p += 2;
+                } else {
+                    found |= (*name == *p);
+                }
+            }
+            if (*p == ']' && found != negate) {
+                pattern = p + 1;
+                name++;
+                continue;
+            }
+        } else if (*pattern == '?' || (*pattern && *pattern == *name)) {
+            pattern++;
+            name++;
+            continue;
+        }
+        // Mismatch: let the last '*' swallow one more character
+        if (!star) {
+            return false;
+        }
+        pattern = star + 1;
+        name = ++resume;
+    }
+    while (*pattern == '*') {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
+
+// List branches matching a name prefix or glob
+void list_matching_branches(const std::string& pattern) {
+    // Check if we're in a gg repository
+    if (!fs::exists(".gg")) {
+        std::cerr << "Error: Not a gg repository (or any of the parent directories)" << std::endl;
+        return;
+    }
+    
+    // Load repository state
+    GGRepo repo = GGRepo::load();
+    
+    // Everything before the first glob character is a literal prefix that
+    // every match shares, so the scan starts at the prefix and stops at the
+    // first name past it. A pattern without glob characters is a prefix.
+    size_t glob_start = pattern.find_first_of("*?[");
+    std::string prefix = pattern.substr(0, glob_start);
+    bool is_glob = glob_start != std::string::npos;
+    
+    auto scan = [&](const std::function<void(const BranchInfo&)>& emit) {
+        repo.branches->scan_from(prefix, [&](const BranchInfo& branch) {
+            if (branch.name.compare(0, prefix.size(), prefix) != 0) {
+                return false;
+            }
+            if (!is_glob || branch_glob_match(pattern.c_str() + prefix.size(), branch.name.c_str() + prefix.size())) {
+                emit(branch);
+            }
+            return true;
+        });
+    };
+    
+    // Headless mode: one branch per line as the scan finds it
+    if (is_headless_mode()) {
+        scan([&](const BranchInfo& branch) {
+            std::cout << (branch.name == repo.current_branch ? "* " : "  ")
+                      << branch.name << " " << branch.commit_id << "\n";
+        });
+        std::cout.flush();
+        return;
+    }
+    
+    // Initialize UI
+    init_ui();
+    clear();
+    
+    // Display header
+    display_header("Branches");
+    
+    attron(COLOR_PAIR(COLOR_DEFAULT));
+    mvprintw(2, 2, "Branches matching '%s':", pattern.c_str());
+    attroff(COLOR_PAIR(COLOR_DEFAULT));
+    
+    // Draw matches while they fit on screen; the rest are only counted
+    int row = 3;
+    size_t matched = 0;
+    scan([&](const BranchInfo& branch) {
+        matched++;
+        if (row >= LINES - 3) {
+            return;
+        }
+        bool is_current = branch.name == repo.current_branch;
+        int color = is_current ? COLOR_HIGHLIGHT : COLOR_BRANCH;
+        attron(COLOR_PAIR(color));
+        mvprintw(row++, 4, "%s %s (%s)", is_current ? "*" : " ", branch.name.c_str(), branch.commit_id.c_str());
+        attroff(COLOR_PAIR(color));
+    });
+    
+    // Display success message
+    attron(COLOR_PAIR(COLOR_SUCCESS));
+    mvprintw(LINES - 2, 2, "[gg] %zu branches matched", matched);
+    attroff(COLOR_PAIR(COLOR_SUCCESS));
+    
+    // Refresh and wait for user input
+    refresh();
+    getch();
+    
+    // Clean up UI
+    cleanup_ui();
+}
+
+// Parse "--count=<n>"; fails unless n is a plain decimal that fits in size_t
+bool parse_branch_count(const std::string& option, size_t& count) {
+    if (option.compare(0, 8, "--count=") != 0 || option.size() == 8 ||
+        option.find_first_not_of("0123456789", 8) != std::string::npos) {
+        return false;
+    }
+    errno = 0;
+    unsigned long long value = std::strtoull(option.c_str() + 8, nullptr, 10);
+    if (errno == ERANGE || value > std::numeric_limits<size_t>::max()) {
+        return false;
+    }
+    count = static_cast<size_t>(value);
+    return true;
+}
+
+// List branches by latest commit time, newest first for "-committerdate";
+// a non-zero count stops after that many
+bool list_sorted_branches(const std::string& sort_key, size_t count) {
+    if (sort_key != "committerdate" && sort_key != "-committerdate") {
+        std::cerr << "Error: Unknown sort key '" << sort_key << "' (use committerdate or -committerdate)" << std::endl;
+        return false;
+    }
+    bool newest_first = sort_key[0] == '-';
+    
+    // Check if we're in a gg repository
+    if (!fs::exists(".gg")) {
+        std::cerr << "Error: Not a gg repository (or any of the parent directories)" << std::endl;
+        return false;
+    }
+    
+    // Load repository state
+    GGRepo repo = GGRepo::load();
+    
+    // Only the branches shown are visited, straight off the recency index
+    size_t shown = 0;
+    auto scan = [&](const std::function<void(const BranchInfo&)>& emit) {
+        repo.branches->scan_by_time(newest_first, [&](const BranchInfo& branch) {
+            emit(branch);
+            return count == 0 || ++shown < count;
+        });
+    };
+    
+    // Headless mode: "<name> <commit> <time>" per branch
+    if (is_headless_mode()) {
+        scan([&](const BranchInfo& branch) {
+            std::cout << (branch.name == repo.current_branch ? "* " : "  ") << branch.name << " "
+                      << branch.commit_id << " " << branch.latest_commit_time << "\n";
+        });
+        std::cout.flush();
+        return true;
+    }
+    
+    // Initialize UI
+    init_ui();
+    clear();
+    
+    // Display header
+    display_header("Branches");
+    
+    attron(COLOR_PAIR(COLOR_DEFAULT));
+    mvprintw(2, 2, "Branches by latest commit (%s first):", newest_first ? "newest" : "oldest");
+    attroff(COLOR_PAIR(COLOR_DEFAULT));
+    
+    int row = 3;
+    size_t listed = 0;
+    scan([&](const BranchInfo& branch) {
+        listed++;
+        if (row >= LINES - 3) {
+            return;
+        }
+        bool is_current = branch.name == repo.current_branch;
+        int color = is_current ? COLOR_HIGHLIGHT : COLOR_BRANCH;
+        attron(COLOR_PAIR(color));
+        mvprintw(row++, 4, "%s %s  %s (%s)", is_current ? "*" : " ", branch.latest_commit_time.c_str(),
+                 branch.name.c_str(), branch.commit_id.c_str());
+        attroff(COLOR_PAIR(color));
+    });
+    
+    // Display success message
+    attron(COLOR_PAIR(COLOR_SUCCESS));
+    mvprintw(LINES - 2, 2, "[gg] %zu branches listed", listed);
+    attroff(COLOR_PAIR(COLOR_SUCCESS));
+    
+    // Refresh and wait for user input
+    refresh();
+    getch();
+    
+    // Clean up UI
+    cleanup_ui();
+    return true;
+}
+
+// Fold the loose branch refs into the packed refs file
+bool pack_refs() {
+    // Check if we're in a gg repository
+    if (!fs::exists(".gg")) {
+        std::cerr << "Error: Not a gg repository (or any of the parent directories)" << std::endl;
+        return false;
+    }
+    
+    GGRepo repo = GGRepo::load();
+    size_t loose = repo.refs->loose_refs();
+    if (!repo.refs->pack(*repo.branches)) {
+        return false;
+    }
+    std::cout << "[gg] Packed " << repo.branches->size() << " branches (" << loose << " loose refs folded in)" << std::endl;
+    return true;
+}
+
 // Command handler for 'gg branch'
 bool branch_command(int argc, char* argv[]) {
     // If no arguments, list branches
@@ -267,6 +588,28 @@ bool branch_command(int argc, char* argv[]) {
         return true;
     }
     
+    // Branches whose history contains a commit
+    if (argc == 3 && strcmp(argv[1], "--contains") == 0) {
+        list_branches(argv[2]);
+        return true;
+    }
+    
+    // Branches matching a prefix or glob
+    if (argc == 3 && strcmp(argv[1], "--list") == 0) {
+        list_matching_branches(argv[2]);
+        return true;
+    }
+    
+    // Branches by latest commit time
+    if ((argc == 2 || argc == 3) && strncmp(argv[1], "--sort=", 7) == 0) {
+        size_t count = 0;
+        if (argc == 3 && !parse_branch_count(argv[2], count)) {
+            std::cerr << "Usage: gg branch --sort=[-]committerdate [--count=<n>]" << std::endl;
+            return false;
+        }
+        return list_sorted_branches(argv[1] + 7, count);
+    }
+    
     // If we have a branch name, create that branch
     if (argc == 2) {
         return create_branch(argv[1]);
@@ -284,5 +627,8 @@ bool branch_command(int argc, char* argv[]) {
     // Invalid usage
     std::cerr << "Usage: gg branch [<branch-name>]" << std::endl;
     std::cerr << "   or: gg branch <branch-name> -c   (create and checkout)" << std::endl;
+    std::cerr << "   or: gg branch --contains <commit>" << std::endl;
+    std::cerr << "   or: gg branch --list <prefix-or-glob>" << std::endl;
+    std::cerr << "   or: gg branch --sort=[-]committerdate [--count=<n>]" << std::endl;
     return false;
 }
@@ -0,0 +1,280 @@
+/**
+ * cuckoo.cpp - Cuckoo filter for file existence checking
+ *
+ * A key's 64-bit hash gives its first bucket (low bits) and its fingerprint
+ * (top 16 bits, never 0). The second bucket is (mix(fingerprint) - first)
+ * mod the bucket count, so either bucket can be computed from the other and
+ * the fingerprint alone; that is what lets entries be moved without the
+ * key. Unlike the usual XOR form this works for any bucket count, so the
+ * table need not be rounded up to a power of two.
+ */
+
+#include "../include/cuckoo.h"
+#include "../include/hash.h"
+#include "../include/serial.h"
+#include <algorithm>
+#include <cmath>
+
+// 16-bit lane helpers for a bucket held in one word
+static const uint64_t LANE_LOW = 0x0001000100010001ULL;
+static const uint64_t LANE_HIGH = 0x8000800080008000ULL;
+
+// High bit set in each lane of word that is zero; the lowest flagged lane
+// is always exact
+static inline uint64_t zero_lanes(uint64_t word) {
+    return (word - LANE_LOW) & ~word & LANE_HIGH;
+}
+
+static inline size_t first_lane(uint64_t flags) {
+    return static_cast<size_t>(__builtin_ctzll(flags)) / CuckooFilter::FINGERPRINT_BITS;
+}
+
+static inline uint64_t lane_shift(size_t lane) {
+    return lane * CuckooFilter::FINGERPRINT_BITS;
+}
+
+// Chance that one occupied slot matches a random fingerprint
+static const double SLOT_MATCH = 1.0 / 65535.0;
+
+// CuckooFilter implementation
+CuckooFilter::CuckooFilter(size_t capacity, double target_fpr) {
+    double slots = static_cast<double>(std::max<size_t>(1, capacity)) / max_load(target_fpr);
+    size_t bucket_count = static_cast<size_t>(std::ceil(slots / SLOTS_PER_BUCKET));
+    buckets.assign(std::max<size_t>(1, bucket_count), 0);
+    item_count = 0;
+    kick_state = 0x9e3779b97f4a7c15ULL;
+    dirty = false;
+    has_victim = false;
+    victim_fingerprint = 0;
+    victim_bucket = 0;
+}
+
+double CuckooFilter::max_load(double target_fpr) {
+    // Inverse of false_positive_probability(): a lookup compares against
+    // 2 * SLOTS_PER_BUCKET * load occupied slots. Cuckoo tables fill to
+    // about 95% before insertions start failing, so looser targets cap there.
+    if (!(target_fpr > 0.0) || target_fpr >= 1.0) {
+        return MAX_LOAD;
+    }
+    double load = std::log1p(-target_fpr) / std::log1p(-SLOT_MATCH) / (2.0 * SLOTS_PER_BUCKET);
+    return std::min(load, MAX_LOAD);
+}
+
+size_t CuckooFilter::alternate_bucket(size_t bucket, uint16_t fingerprint) const {
+    size_t count = buckets.size();
+    size_t mixed = static_cast<size_t>((fingerprint * 0x5bd1e995ULL) >> 8) % count;
+    return (mixed + count - bucket) % count;
+}
+
+void CuckooFilter::locate(const std::string& item, uint16_t& fingerprint, size_t& first, size_t& second) const {
+    uint64_t hash = hash64(item);
+    fingerprint = static_cast<uint16_t>(hash >> 48);
+    if (fingerprint == 0) {
+        fingerprint = 1; // 0 marks an empty slot
+    }
+    first = static_cast<size_t>((static_cast<uint32_t>(hash) * static_cast<uint64_t>(buckets.size())) >> 32);
+    second = alternate_bucket(first, fingerprint);
+}
+
+bool CuckooFilter::bucket_contains(size_t bucket, uint16_t fingerprint) const {
+    return zero_lanes(buckets[bucket] ^ (fingerprint * LANE_LOW)) != 0;
+}
+
+bool CuckooFilter::bucket_insert(size_t bucket, uint16_t fingerprint) {
+    uint64_t empty = zero_lanes(buckets[bucket]);
+    if (!empty) {
+        return false;
+    }
+    buckets[bucket] |= static_cast<uint64_t>(fingerprint) << lane_shift(first_lane(empty));
+    return true;
+}
+
+bool CuckooFilter::bucket_remove(size_t bucket, uint16_t fingerprint) {
+    uint64_t match = zero_lanes(buckets[bucket] ^ (fingerprint * LANE_LOW));
+    if (!match) {
+        return false;
+    }
+    buckets[bucket] &= ~(uint64_t(0xffff) << lane_shift(first_lane(match)));
+    return true;
+}
+
+bool CuckooFilter::add(const std::string& item) {
+    uint16_t fingerprint;
+    size_t first, second;
+    locate(item, fingerprint, first, second);
+
+    if (bucket_insert(first, fingerprint) || bucket_insert(second, fingerprint)) {
+        item_count++;
+        dirty = true;
+        return true;
+    }
+    if (has_victim) {
+        return false;
+    }
+    dirty = true;
+
+    // Both buckets are full: evict a random resident to its other bucket,
+    // and so on until one lands in a free slot
+    size_t bucket = (kick_state & 1) ? first : second;
+    for (size_t kick = 0; kick < MAX_KICKS; ++kick) {
+        kick_state ^= kick_state << 13;
+        kick_state ^= kick_state >> 7;
+        kick_state ^= kick_state << 17;
+
+        uint64_t shift = lane_shift(kick_state % SLOTS_PER_BUCKET);
+        uint16_t evicted = static_cast<uint16_t>(buckets[bucket] >> shift);
+        buckets[bucket] = (buckets[bucket] & ~(uint64_t(0xffff) << shift)) |
+                          (static_cast<uint64_t>(fingerprint) << shift);
+
+        fingerprint = evicted;
+        bucket = alternate_bucket(bucket, fingerprint);
+        if (bucket_insert(bucket, fingerprint)) {
+            item_count++;
+            return true;
+        }
+    }
+
+    // Park the last evicted fingerprint so no member is lost
+    has_victim = true;
+    victim_fingerprint = fingerprint;
+    victim_bucket = bucket;
+    item_count++;
+    return true;
+}
+
+bool CuckooFilter::might_contain(const std::string& item) const {
+    uint16_t fingerprint;
+    size_t first, second;
+    locate(item, fingerprint, first, second);
+
+    if (bucket_contains(first, fingerprint) || bucket_contains(second, fingerprint)) {
+        return true;
+    }
+    return has_victim && victim_fingerprint == fingerprint &&
+           (victim_bucket == first || victim_bucket == second);
+}
+
+bool CuckooFilter::remove(const std::string& item) {
+    uint16_t fingerprint;
+    size_t first, second;
+    locate(item, fingerprint, first, second);
+
+    if (bucket_remove(first, fingerprint) || bucket_remove(second, fingerprint)) {
+        item_count--;
+        dirty = true;
+
+        // A slot just opened up; try to take the parked fingerprint back
+        if (has_victim && (bucket_insert(victim_bucket, victim_fingerprint) ||
+                           bucket_insert(alternate_bucket(victim_bucket, victim_fingerprint), victim_fingerprint))) {
+            has_victim = false;
+        }
+        return true;
+    }
+    if (has_victim && victim_fingerprint == fingerprint &&
+        (victim_bucket == first || victim_bucket == second)) {
+        has_victim = false;
+        item_count--;
+        dirty = true;
+        return true;
+    }
+    return false;
+}
+
+void CuckooFilter::clear() {
+    std::fill(buckets.begin(), buckets.end(), 0);
+    item_count = 0;
+    has_victim = false;
+    dirty = true;
+}
+
+double CuckooFilter::false_positive_probability() const {
+    // A lookup compares against every occupied slot of two buckets, and
+    // each comparison matches with probability 1/65535
+    double occupied = 2.0 * SLOTS_PER_BUCKET * load_factor();
+    return 1.0 - std::pow(1.0 - SLOT_MATCH, occupied);
+}
+
+double CuckooFilter::load_factor() const {
+    return static_cast<double>(item_count) / static_cast<double>(get_capacity());
+}
+
+size_t CuckooFilter::get_item_count() const {
+    return item_count;
+}
+
+size_t CuckooFilter::get_capacity() const {
+    return buckets.size() * SLOTS_PER_BUCKET;
+}
+
+size_t CuckooFilter::get_size() const {
+    return buckets.size() * 64;
+}
+
+bool CuckooFilter::is_full() const {
+    return has_victim;
+}
+
+bool CuckooFilter::is_dirty() const {
+    return dirty;
+}
+
+void CuckooFilter::clear_dirty() {
+    dirty = false;
+}
+
+void CuckooFilter::draw(WINDOW* win, int start_y, int start_x, int width, int height) const {
+    // One cell per bucket of the first buckets: number of used slots
+    size_t cells = std::min(static_cast<size_t>(std::max(0, width * height)), buckets.size());
+    for (size_t i = 0; i < cells; ++i) {
+        size_t used = 0;
+        for (size_t lane = 0; lane < SLOTS_PER_BUCKET; ++lane) {
+            used += ((buckets[i] >> lane_shift(lane)) & 0xffff) != 0;
+        }
+        mvwaddch(win, start_y + static_cast<int>(i) / width, start_x + static_cast<int>(i) % width,
+                 used ? static_cast<chtype>('0' + used) : '.');
+    }
+}
+
+std::string CuckooFilter::serialize() const {
+    BinaryWriter writer;
+    writer.write_header("GGCF");
+    writer.write_u64(buckets.size());
+    writer.write_u64(item_count);
+    writer.write_u8(has_victim ? 1 : 0);
+    writer.write_u32(victim_fingerprint);
+    writer.write_u64(victim_bucket);
+    for (uint64_t bucket : buckets) {
+        writer.write_u64(bucket);
+    }
+    return writer.data();
+}
+
+CuckooFilter CuckooFilter::deserialize(const std::string& data) {
+    BinaryReader reader(data);
+    if (!reader.read_header("GGCF")) {
+        return CuckooFilter();
+    }
+
+    uint64_t bucket_count = reader.read_u64();
+    uint64_t items = reader.read_u64();
+    bool victim = reader.read_u8() != 0;
+    uint32_t fingerprint = reader.read_u32();
+    uint64_t bucket = reader.read_u64();
+    if (!reader.ok() || bucket_count == 0 || bucket_count > data.size() / 8 || bucket >= bucket_count) {
+        return CuckooFilter();
+    }
+
+    CuckooFilter filter;
+    filter.buckets.assign(bucket_count, 0);
+    for (uint64_t& word : filter.buckets) {
+        word = reader.read_u64();
+    }
+    if (!reader.ok()) {
+        return CuckooFilter();
+    }
+    filter.item_count = items;
+    filter.has_victim = victim;
+    filter.victim_fingerprint = static_cast<uint16_t>(fingerprint);
+    filter.victim_bucket = bucket;
+    return filter;
+}
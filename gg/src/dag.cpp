@@ -0,0 +1,308 @@
+/**
+ * dag.cpp - Index-based commit graph
+ *
+ * Commits only ever gain parents that already exist, so appending a commit
+ * appends its parents to the parent CSR arrays. Children would have to be
+ * inserted in the middle of theirs, so they are instead rebuilt from the
+ * parent arrays in one counting pass the first time they are needed.
+ */
+
+#include "../include/dag.h"
+#include "../include/hash.h"
+#include "../include/serial.h"
+#include <algorithm>
+
+// Commit implementation
+Commit::Commit(const std::string& id, const std::string& message,
+               const std::string& author, const std::string& timestamp) {
+    this->id = id;
+    this->message = message;
+    this->author = author;
+    this->timestamp = timestamp;
+}
+
+// DAG implementation
+DAG::DAG() : children_valid(false), head(NO_COMMIT), dirty(false) {
+    parent_offsets.push_back(0);
+}
+
+void DAG::insert_id(CommitIndex index) {
+    size_t mask = id_slots.size() - 1;
+    size_t slot = hash64(commits[index].id) & mask;
+    while (id_slots[slot] != NO_COMMIT) {
+        slot = (slot + 1) & mask;
+    }
+    id_slots[slot] = index;
+}
+
+void DAG::grow_id_table() {
+    // Keep the table at most half full so probe runs stay short
+    size_t capacity = id_slots.empty() ? 16 : id_slots.size() * 2;
+    id_slots.assign(capacity, NO_COMMIT);
+    for (CommitIndex i = 0; i < commits.size(); ++i) {
+        insert_id(i);
+    }
+}
+
+CommitIndex DAG::add_commit(const Commit& commit, const std::vector<std::string>& parent_ids) {
+    CommitIndex existing = find(commit.id);
+    if (existing != NO_COMMIT) {
+        return existing;
+    }
+
+    CommitIndex index = static_cast<CommitIndex>(commits.size());
+    for (const auto& parent_id : parent_ids) {
+        CommitIndex parent = find(parent_id);
+        if (parent != NO_COMMIT) {
+            parent_list.push_back(parent);
+        }
+    }
+    parent_offsets.push_back(static_cast<uint32_t>(parent_list.size()));
+    commits.push_back(commit);
+    children_valid = false;
+    dirty = true;
+
+    if ((commits.size() * 2) > id_slots.size()) {
+        grow_id_table();
+    } else {
+        insert_id(index);
+    }
+
+    if (parent_ids.empty() || head == NO_COMMIT) {
+        head = index;
+    }
+    return index;
+}
+
+CommitIndex DAG::find(const std::string& commit_id) const {
+    if (id_slots.empty()) {
+        return NO_COMMIT;
+    }
+
+    size_t mask = id_slots.size() - 1;
+    for (size_t slot = hash64(commit_id) & mask; id_slots[slot] != NO_COMMIT; slot = (slot + 1) & mask) {
+        if (commits[id_slots[slot]].id == commit_id) {
+            return id_slots[slot];
+        }
+    }
+    return NO_COMMIT;
+}
+
+const Commit* DAG::get_commit(const std::string& commit_id) const {
+    CommitIndex index = find(commit_id);
+    return index != NO_COMMIT ? &commits[index] : nullptr;
+}
+
+const Commit& DAG::commit_at(CommitIndex index) const {
+    return commits[index];
+}
+
+bool DAG::set_head(const std::string& commit_id) {
+    CommitIndex index = find(commit_id);
+    if (index == NO_COMMIT) {
+        return false;
+    }
+
+    if (head != index) {
+        head = index;
+        dirty = true;
+    }
+    return true;
+}
+
+CommitIndex DAG::get_head() const {
+    return head;
+}
+
+size_t DAG::size() const {
+    return commits.size();
+}
+
+bool DAG::is_dirty() const {
+    return dirty;
+}
+
+void DAG::clear_dirty() {
+    dirty = false;
+}
+
+CommitRange DAG::parents(CommitIndex index) const {
+    const CommitIndex* base = parent_list.data();
+    return {base + parent_offsets[index], base + parent_offsets[index + 1]};
+}
+
+void DAG::build_children() const {
+    // Counting sort of the parent edges by parent; scanning children in
+    // index order keeps each commit's children in the order they were added
+    child_offsets.assign(commits.size() + 1, 0);
+    for (CommitIndex parent : parent_list) {
+        child_offsets[parent + 1]++;
+    }
+    for (size_t i = 0; i < commits.size(); ++i) {
+        child_offsets[i + 1] += child_offsets[i];
+    }
+
+    child_list.resize(parent_list.size());
+    std::vector<uint32_t> next(child_offsets.begin(), child_offsets.end() - 1);
+    for (CommitIndex child = 0; child < commits.size(); ++child) {
+        for (CommitIndex parent : parents(child)) {
+            child_list[next[parent]++] = child;
+        }
+    }
+    children_valid = true;
+}
+
+CommitRange DAG::children(CommitIndex index) const {
+    if (!children_valid) {
+        build_children();
+    }
+    const CommitIndex* base = child_list.data();
+    return {base + child_offsets[index], base + child_offsets[index + 1]};
+}
+
+std::vector<CommitIndex> DAG::get_ancestors(const std::string& commit_id) const {
+    std::vector<CommitIndex> result;
+    CommitIndex start = find(commit_id);
+    if (start == NO_COMMIT) return result;
+
+    // Breadth-first along parent edges; the result doubles as the queue
+    std::vector<bool> visited(commits.size(), false);
+    visited[start] = true;
+    for (CommitIndex parent : parents(start)) {
+        if (!visited[parent]) {
+            visited[parent] = true;
+            result.push_back(parent);
+        }
+    }
+    for (size_t next = 0; next < result.size(); ++next) {
+        for (CommitIndex parent : parents(result[next])) {
+            if (!visited[parent]) {
+                visited[parent] = true;
+                result.push_back(parent);
+            }
+        }
+    }
+
+    return result;
+}
+
+std::vector<CommitIndex> DAG::breadth_first_search() const {
+    std::vector<CommitIndex> result;
+    if (head == NO_COMMIT) return result;
+
+    // The result doubles as the queue
+    std::vector<bool> visited(commits.size(), false);
+    result.reserve(commits.size());
+    result.push_back(head);
+    visited[head] = true;
+
+    for (size_t next = 0; next < result.size(); ++next) {
+        for (CommitIndex child : children(result[next])) {
+            if (!visited[child]) {
+                visited[child] = true;
+                result.push_back(child);
+            }
+        }
+    }
+
+    return result;
+}
+
+std::vector<CommitIndex> DAG::depth_first_search() const {
+    std::vector<CommitIndex> result;
+    if (head == NO_COMMIT) return result;
+
+    std::vector<bool> visited(commits.size(), false);
+    std::vector<CommitIndex> stack = {head};
+    result.reserve(commits.size());
+
+    while (!stack.empty()) {
+        CommitIndex node = stack.back();
+        stack.pop_back();
+        if (visited[node]) {
+            continue;
+        }
+        visited[node] = true;
+        result.push_back(node);
+
+        // Push in reverse so the first child is visited first
+        CommitRange next = children(node);
+        for (const CommitIndex* it = next.end(); it != next.begin(); ) {
+            --it;
+            if (!visited[*it]) {
+                stack.push_back(*it);
+            }
+        }
+    }
+
+    return result;
+}
+
+void DAG::draw(WINDOW* win, const std::string& current_commit) const {
+    // Stub implementation - does nothing in non-ncurses mode
+    (void)win;
+    (void)current_commit;
+}
+
+std::string DAG::serialize() const {
+    // Indices are already a topological order (parents first), so
+    // deserialize() can link every commit to already-loaded parents
+    BinaryWriter writer;
+    writer.write_header("GGDG");
+    writer.write_string(head != NO_COMMIT ? commits[head].id : "");
+    writer.write_u32(static_cast<uint32_t>(commits.size()));
+    for (const Commit& commit : commits) {
+        writer.write_string(commit.id);
+        writer.write_string(commit.message);
+        writer.write_string(commit.author);
+        writer.write_string(commit.timestamp);
+        writer.write_u32(static_cast<uint32_t>(commit.parent_ids.size()));
+        for (const auto& parent_id : commit.parent_ids) {
+            writer.write_string(parent_id);
+        }
+        writer.write_u32(static_cast<uint32_t>(commit.file_snapshots.size()));
+        for (const auto& [file, hash] : commit.file_snapshots) {
+            writer.write_string(file);
+            writer.write_string(hash);
+        }
+    }
+    return writer.data();
+}
+
+DAG DAG::deserialize(const std::string& data) {
+    DAG dag;
+    BinaryReader reader(data);
+    if (!reader.read_header("GGDG")) {
+        return dag;
+    }
+
+    std::string head_id = reader.read_string();
+    uint32_t count = reader.read_u32();
+    dag.commits.reserve(std::min<size_t>(count, data.size() / 16));
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        Commit commit;
+        commit.id = reader.read_string();
+        commit.message = reader.read_string();
+        commit.author = reader.read_string();
+        commit.timestamp = reader.read_string();
+
+        uint32_t parent_count = reader.read_u32();
+        for (uint32_t p = 0; p < parent_count && reader.ok(); ++p) {
+            commit.parent_ids.push_back(reader.read_string());
+        }
+
+        uint32_t snapshot_count = reader.read_u32();
+        for (uint32_t s = 0; s < snapshot_count && reader.ok(); ++s) {
+            std::string file = reader.read_string();
+            commit.file_snapshots[file] = reader.read_string();
+        }
+
+        if (reader.ok()) {
+            dag.add_commit(commit, commit.parent_ids);
+        }
+    }
+
+    dag.set_head(head_id);
+    dag.dirty = false;
+    return dag;
+}
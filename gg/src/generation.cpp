@@ -0,0 +1,214 @@
+/**
+ * generation.cpp - Generation numbers and merge bases for the commit graph
+ *
+ * The merge-base walk is a paint-down: both tips go on a queue ordered by
+ * generation, each commit passes the sides that reach it on to its parents,
+ * and a commit reached from both sides is a merge base. Its ancestors are
+ * marked stale, since they are common but not best, and the walk ends once
+ * every commit left on the queue is stale. Commits below the merge bases
+ * are never visited.
+ */
+
+#include "../include/generation.h"
+#include "../include/serial.h"
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+// Walk flags: which tips reach a commit, and whether it is below a base
+static const uint8_t REACHED_OURS = 1;
+static const uint8_t REACHED_THEIRS = 2;
+static const uint8_t STALE = 4;
+static const uint8_t QUEUED = 8;
+static const uint8_t REACHED_BOTH = REACHED_OURS | REACHED_THEIRS;
+
+// GenerationIndex implementation
+void GenerationIndex::update(const DAG& dag) {
+    if (generations.size() > dag.size() || dates.size() != generations.size() ||
+        (!generations.empty() && dag.commit_at(generations.size() - 1).id != last_id)) {
+        generations.clear();
+        dates.clear();
+        dirty = true;
+    }
+    if (generations.size() == dag.size()) {
+        return;
+    }
+    dirty = true;
+
+    // Parents always have smaller indices, so one pass in index order
+    // sees every parent's generation before its children need it
+    generations.reserve(dag.size());
+    dates.reserve(dag.size());
+    for (CommitIndex index = static_cast<CommitIndex>(generations.size()); index < dag.size(); ++index) {
+        uint32_t generation = 1;
+        for (CommitIndex parent : dag.parents(index)) {
+            generation = std::max(generation, generations[parent] + 1);
+        }
+        generations.push_back(generation);
+        dates.push_back(parse_timestamp(dag.commit_at(index).timestamp));
+    }
+    last_id = dag.commit_at(dag.size() - 1).id;
+}
+
+uint32_t GenerationIndex::generation(CommitIndex index) const {
+    return generations[index];
+}
+
+int64_t GenerationIndex::date(CommitIndex index) const {
+    return dates[index];
+}
+
+size_t GenerationIndex::size() const {
+    return generations.size();
+}
+
+bool GenerationIndex::is_dirty() const {
+    return dirty;
+}
+
+void GenerationIndex::clear_dirty() {
+    dirty = false;
+}
+
+MergeBaseWalk GenerationIndex::walk(const DAG& dag, CommitIndex ours, CommitIndex theirs) const {
+    MergeBaseWalk result;
+    if (ours >= generations.size() || theirs >= generations.size()) {
+        return result;
+    }
+
+    // Highest generation first; dates and then indices break ties so the
+    // order is deterministic
+    auto lower = [this](CommitIndex a, CommitIndex b) {
+        if (generations[a] != generations[b]) return generations[a] < generations[b];
+        if (dates[a] != dates[b]) return dates[a] < dates[b];
+        return a < b;
+    };
+    std::priority_queue<CommitIndex, std::vector<CommitIndex>, decltype(lower)> queue(lower);
+
+    // Flags only for the commits the walk touches, so its cost does not
+    // depend on the size of the history
+    std::unordered_map<CommitIndex, uint8_t> flags;
+    size_t active = 0; // Queued commits that are not stale
+
+    auto paint = [&](CommitIndex index, uint8_t paint_flags) {
+        uint8_t& current = flags[index];
+        if ((current & paint_flags) == paint_flags) {
+            return;
+        }
+        if (current & QUEUED) {
+            if ((paint_flags & STALE) && !(current & STALE)) {
+                active--;
+            }
+            current |= paint_flags;
+            return;
+        }
+        current |= paint_flags | QUEUED;
+        if (!(current & STALE)) {
+            active++;
+        }
+        queue.push(index);
+    };
+
+    paint(ours, REACHED_OURS);
+    paint(theirs, REACHED_THEIRS);
+
+    while (active > 0) {
+        CommitIndex index = queue.top();
+        queue.pop();
+        result.visited++;
+
+        uint8_t& current = flags[index];
+        current &= ~QUEUED;
+        if (!(current & STALE)) {
+            active--;
+        }
+
+        // Every descendant in the walk has been processed, so the flags
+        // are final: a commit reached from both sides and not below an
+        // earlier base is a best common ancestor
+        uint8_t reached = current & (REACHED_BOTH | STALE);
+        if ((reached & REACHED_BOTH) == REACHED_BOTH && !(reached & STALE)) {
+            result.bases.push_back(index);
+            current |= STALE;
+            reached |= STALE;
+        } else if (!(reached & STALE)) {
+            (reached & REACHED_OURS ? result.only_ours : result.only_theirs).push_back(index);
+        }
+
+        for (CommitIndex parent : dag.parents(index)) {
+            paint(parent, reached);
+        }
+    }
+
+    return result;
+}
+
+CommitIndex GenerationIndex::merge_base(const DAG& dag, CommitIndex ours, CommitIndex theirs) const {
+    MergeBaseWalk result = walk(dag, ours, theirs);
+    return result.bases.empty() ? NO_COMMIT : result.bases.front();
+}
+
+bool GenerationIndex::is_ancestor(const DAG& dag, CommitIndex ancestor, CommitIndex descendant) const {
+    if (ancestor >= generations.size() || descendant >= generations.size()) {
+        return false;
+    }
+
+    // Only commits with a larger generation can lead down to the ancestor
+    uint32_t floor = generations[ancestor];
+    std::vector<CommitIndex> stack = {descendant};
+    std::unordered_set<CommitIndex> seen = {descendant};
+    while (!stack.empty()) {
+        CommitIndex index = stack.back();
+        stack.pop_back();
+        if (index == ancestor) {
+            return true;
+        }
+        for (CommitIndex parent : dag.parents(index)) {
+            if (generations[parent] >= floor && seen.insert(parent).second) {
+                stack.push_back(parent);
+            }
+        }
+    }
+    return false;
+}
+
+std::string GenerationIndex::serialize() const {
+    BinaryWriter writer;
+    writer.write_header("GGCG");
+    writer.write_string(last_id);
+    writer.write_u32(static_cast<uint32_t>(generations.size()));
+    for (size_t i = 0; i < generations.size(); ++i) {
+        writer.write_u32(generations[i]);
+        writer.write_u64(static_cast<uint64_t>(dates[i]));
+    }
+    return writer.data();
+}
+
+GenerationIndex GenerationIndex::deserialize(const std::string& data) {
+    GenerationIndex index;
+    BinaryReader reader(data);
+    if (!reader.read_header("GGCG")) {
+        return index;
+    }
+
+    index.last_id = reader.read_string();
+    uint32_t count = reader.read_u32();
+    index.generations.reserve(std::min<size_t>(count, data.size() / 12));
+    index.dates.reserve(std::min<size_t>(count, data.size() / 12));
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        uint32_t generation = reader.read_u32();
+        int64_t date = static_cast<int64_t>(reader.read_u64());
+        if (reader.ok()) {
+            index.generations.push_back(generation);
+            index.dates.push_back(date);
+        }
+    }
+
+    // A truncated file no longer matches last_id; update() starts over
+    if (index.generations.size() != count) {
+        index.generations.clear();
+        index.dates.clear();
+    }
+    return index;
+}
@@ -0,0 +1,350 @@
+/**
+ * hash.cpp - SHA-256 content hashing for the object store
+ *
+ * Provides a portable SHA-256 and, on x86 with the SHA extensions, a SHA-NI
+ * compression function that processes a 64-byte block in a handful of
+ * instructions. The implementation is chosen once via CPUID.
+ *
+ * Also provides hash64(), a port of wyhash (final version 4): 48 bytes per
+ * loop iteration, each step a 64x64->128 bit multiply folded to 64 bits.
+ */
+
+#include "../include/hash.h"
+#include <cstring>
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GG_HAVE_SHA_NI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+// Portable compression over a run of 64-byte blocks
+static void compress_portable(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    for (size_t b = 0; b < blocks; ++b, data += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (uint32_t(data[4 * i]) << 24) | (uint32_t(data[4 * i + 1]) << 16) |
+                   (uint32_t(data[4 * i + 2]) << 8) | uint32_t(data[4 * i + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b2 = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b2) ^ (a & c) ^ (b2 & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b2; b2 = a; a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b2; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#ifdef GG_HAVE_SHA_NI
+// SHA-NI compression: each group of four rounds is two sha256rnds2 calls,
+// with the message schedule kept in four rolling registers
+__attribute__((target("sha,sse4.1,ssse3")))
+static void compress_sha_ni(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);                 // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);           // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);   // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);        // CDGH
+
+    for (size_t b = 0; b < blocks; ++b, data += 64) {
+        __m128i abef_save = state0;
+        __m128i cdgh_save = state1;
+        __m128i w[4];
+
+        for (int g = 0; g < 16; ++g) {
+            if (g < 4) {
+                w[g] = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * g)), MASK);
+            }
+
+            __m128i msg = _mm_add_epi32(w[g % 4],
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(&K[4 * g])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+
+            if (g >= 3 && g <= 14) {
+                __m128i next = _mm_add_epi32(w[(g + 1) % 4], _mm_alignr_epi8(w[g % 4], w[(g + 3) % 4], 4));
+                w[(g + 1) % 4] = _mm_sha256msg2_epu32(next, w[g % 4]);
+            }
+
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+            if (g >= 1 && g <= 12) {
+                w[(g + 3) % 4] = _mm_sha256msg1_epu32(w[(g + 3) % 4], w[g % 4]);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);              // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);           // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);        // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);           // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+static bool cpu_has_sha_ni() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    bool ssse3 = (ecx & (1u << 9)) != 0;
+    bool sse41 = (ecx & (1u << 19)) != 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    bool sha = (ebx & (1u << 29)) != 0;
+    return ssse3 && sse41 && sha;
+}
+#endif
+
+typedef void (*CompressFunction)(uint32_t*, const uint8_t*, size_t);
+
+// Pick the compression function once, at startup
+static CompressFunction select_compress() {
+#ifdef GG_HAVE_SHA_NI
+    if (cpu_has_sha_ni()) {
+        return compress_sha_ni;
+    }
+#endif
+    return compress_portable;
+}
+
+static const CompressFunction compress = select_compress();
+
+// Sha256 implementation
+Sha256::Sha256() {
+    reset();
+}
+
+void Sha256::reset() {
+    static const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    std::memcpy(state, initial, sizeof(state));
+    block_length = 0;
+    total_length = 0;
+}
+
+void Sha256::update(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    total_length += length;
+
+    // Top up a partially filled block first
+    if (block_length > 0) {
+        size_t take = std::min(length, sizeof(block) - block_length);
+        std::memcpy(block + block_length, bytes, take);
+        block_length += take;
+        bytes += take;
+        length -= take;
+        if (block_length < sizeof(block)) {
+            return;
+        }
+        compress(state, block, 1);
+        block_length = 0;
+    }
+
+    // Whole blocks are compressed straight from the caller's buffer
+    size_t blocks = length / 64;
+    if (blocks > 0) {
+        compress(state, bytes, blocks);
+        bytes += blocks * 64;
+        length -= blocks * 64;
+    }
+
+    std::memcpy(block, bytes, length);
+    block_length = length;
+}
+
+void Sha256::update(const std::string& data) {
+    update(data.data(), data.size());
+}
+
+std::string Sha256::finish_hex() {
+    uint64_t bit_length = total_length * 8;
+
+    uint8_t padding[72] = {0x80};
+    size_t pad_length = (block_length < 56) ? (56 - block_length) : (120 - block_length);
+    update(padding, pad_length);
+
+    uint8_t length_bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        length_bytes[i] = static_cast<uint8_t>(bit_length >> (56 - 8 * i));
+    }
+    update(length_bytes, 8);
+
+    static const char hex_chars[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(DIGEST_SIZE * 2);
+    for (int i = 0; i < 8; ++i) {
+        for (int shift = 28; shift >= 0; shift -= 4) {
+            hex += hex_chars[(state[i] >> shift) & 0xf];
+        }
+    }
+
+    reset();
+    return hex;
+}
+
+bool Sha256::hardware_accelerated() {
+    return compress != compress_portable;
+}
+
+std::string sha256_hex(const std::string& data) {
+    Sha256 hasher;
+    hasher.update(data);
+    return hasher.finish_hex();
+}
+
+std::string hex_to_bytes(const std::string& hex) {
+    std::string bytes;
+    bytes.reserve(hex.size() / 2);
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        bytes += static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16));
+    }
+    return bytes;
+}
+
+std::string bytes_to_hex(const std::string& bytes) {
+    static const char hex_chars[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(bytes.size() * 2);
+    for (unsigned char c : bytes) {
+        hex += hex_chars[c >> 4];
+        hex += hex_chars[c & 0xf];
+    }
+    return hex;
+}
+
+// wyhash
+static const uint64_t WY_SECRET[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+// 64x64 -> 128 bit multiply, low half into a and high half into b
+static inline void wy_mum(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    a = lo;
+    b = hi;
+#endif
+}
+
+static inline uint64_t wy_mix(uint64_t a, uint64_t b) {
+    wy_mum(a, b);
+    return a ^ b;
+}
+
+// Little-endian loads
+static inline uint64_t wy_read8(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline uint64_t wy_read4(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+static inline uint64_t wy_read3(const uint8_t* p, size_t k) {
+    return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+uint64_t hash64(const void* data, size_t length, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    seed ^= wy_mix(seed ^ WY_SECRET[0], WY_SECRET[1]);
+    uint64_t a, b;
+
+    if (length <= 16) {
+        if (length >= 4) {
+            a = (wy_read4(p) << 32) | wy_read4(p + ((length >> 3) << 2));
+            b = (wy_read4(p + length - 4) << 32) | wy_read4(p + length - 4 - ((length >> 3) << 2));
+        } else if (length > 0) {
+            a = wy_read3(p, length);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = length;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = wy_mix(wy_read8(p) ^ WY_SECRET[1], wy_read8(p + 8) ^ seed);
+                see1 = wy_mix(wy_read8(p + 16) ^ WY_SECRET[2], wy_read8(p + 24) ^ see1);
+                see2 = wy_mix(wy_read8(p + 32) ^ WY_SECRET[3], wy_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wy_mix(wy_read8(p) ^ WY_SECRET[1], wy_read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = wy_read8(p + i - 16);
+        b = wy_read8(p + i - 8);
+    }
+
+    a ^= WY_SECRET[1];
+    b ^= seed;
+    wy_mum(a, b);
+    return wy_mix(a ^ WY_SECRET[0] ^ length, b ^ WY_SECRET[1]);
+}
+
+uint64_t hash64(const std::string& data, uint64_t seed) {
+    return hash64(data.data(), data.size(), seed);
+}
@@ -0,0 +1,340 @@
+/**
+ * ignore.cpp - .ggignore pattern matching
+ *
+ * Globs are compiled to a token list and run as an NFA whose state set is a
+ * 64-bit mask (bit i = "before token i"), so matching is a few bit operations
+ * per character with no backtracking and no allocation.
+ */
+
+#include "../include/ignore.h"
+#include "../include/serial.h"
+#include "../include/hash.h"
+#include "../include/gg.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+
+// Glob compilation and simulation
+static bool compile_glob(const std::string& text, std::vector<GlobToken>& tokens) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+
+        if (c == '\\' && i + 1 < text.size()) {
+            tokens.emplace_back(GlobToken::Type::CHAR, text[++i]);
+        } else if (c == '*') {
+            size_t run_start = i;
+            bool double_star = i + 1 < text.size() && text[i + 1] == '*';
+            while (i + 1 < text.size() && text[i + 1] == '*') {
+                ++i;
+            }
+            if (!double_star) {
+                tokens.emplace_back(GlobToken::Type::STAR);
+            } else if (i + 1 < text.size() && text[i + 1] == '/' && (run_start == 0 || text[run_start - 1] == '/')) {
+                // "**/" as a whole path component: zero or more directories
+                tokens.emplace_back(GlobToken::Type::ANY_DIRS);
+                ++i;
+            } else {
+                tokens.emplace_back(GlobToken::Type::DOUBLE_STAR);
+            }
+        } else if (c == '?') {
+            tokens.emplace_back(GlobToken::Type::ANY);
+        } else if (c == '[' && text.find(']', i + 2) != std::string::npos) {
+            GlobToken token(GlobToken::Type::CLASS);
+            size_t j = i + 1;
+            bool negate = text[j] == '!' || text[j] == '^';
+            if (negate) {
+                ++j;
+            }
+
+            // A ']' right after the opening bracket is a member, not the end
+            size_t start = j;
+            while (j < text.size() && (text[j] != ']' || j == start)) {
+                unsigned char low = static_cast<unsigned char>(text[j]);
+                if (j + 2 < text.size() && text[j + 1] == '-' && text[j + 2] != ']') {
+                    unsigned char high = static_cast<unsigned char>(text[j + 2]);
+                    for (unsigned int ch = low; ch <= high; ++ch) {
+                        token.set.set(ch);
+                    }
+                    j += 3;
+                } else {
+                    token.set.set(low);
+                    ++j;
+                }
+            }
+            if (j >= text.size()) {
+                tokens.emplace_back(GlobToken::Type::CHAR, c);
+                continue;
+            }
+
+            if (negate) {
+                token.set.flip();
+            }
+            tokens.push_back(token);
+            i = j;
+        } else {
+            tokens.emplace_back(GlobToken::Type::CHAR, c);
+        }
+    }
+    return tokens.size() <= IgnoreMatcher::MAX_GLOB_TOKENS;
+}
+
+static bool run_glob(const std::vector<GlobToken>& tokens, const std::string& subject) {
+    const size_t count = tokens.size();
+
+    // Follow the empty-match edges of star tokens; they only point forward,
+    // so one ascending pass reaches every state
+    auto closure = [&tokens, count](uint64_t states) {
+        for (size_t i = 0; i < count; ++i) {
+            if ((states >> i) & 1) {
+                GlobToken::Type type = tokens[i].type;
+                if (type == GlobToken::Type::STAR || type == GlobToken::Type::DOUBLE_STAR ||
+                    type == GlobToken::Type::ANY_DIRS) {
+                    states |= uint64_t(1) << (i + 1);
+                }
+            }
+        }
+        return states;
+    };
+
+    uint64_t states = closure(1);
+    for (char ch : subject) {
+        uint64_t next = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (!((states >> i) & 1)) {
+                continue;
+            }
+            const GlobToken& token = tokens[i];
+            uint64_t stay = uint64_t(1) << i;
+            uint64_t advance = uint64_t(1) << (i + 1);
+
+            switch (token.type) {
+                case GlobToken::Type::CHAR:
+                    if (ch == token.c) next |= advance;
+                    break;
+                case GlobToken::Type::ANY:
+                    if (ch != '/') next |= advance;
+                    break;
+                case GlobToken::Type::CLASS:
+                    if (ch != '/' && token.set.test(static_cast<unsigned char>(ch))) next |= advance;
+                    break;
+                case GlobToken::Type::STAR:
+                    if (ch != '/') next |= stay;
+                    break;
+                case GlobToken::Type::DOUBLE_STAR:
+                    next |= stay;
+                    break;
+                case GlobToken::Type::ANY_DIRS:
+                    next |= stay;
+                    if (ch == '/') next |= advance;
+                    break;
+            }
+        }
+
+        states = closure(next);
+        if (states == 0) {
+            return false;
+        }
+    }
+    return (states >> count) & 1;
+}
+
+// IgnorePattern implementation
+bool IgnorePattern::matches(const std::string& path, const std::string& name) const {
+    const std::string& subject = anchored ? path : name;
+
+    switch (kind) {
+        case Kind::LITERAL:
+            return subject == text;
+        case Kind::PREFIX:
+            return subject.compare(0, text.size(), text) == 0 &&
+                   subject.find('/', text.size()) == std::string::npos;
+        case Kind::SUFFIX:
+            return subject.size() >= text.size() &&
+                   subject.compare(subject.size() - text.size(), text.size(), text) == 0 &&
+                   subject.find('/') == std::string::npos;
+        case Kind::GLOB:
+            return run_glob(glob, subject);
+    }
+    return false;
+}
+
+// IgnoreMatcher implementation
+IgnoreMatcher::IgnoreMatcher() : seen(1) {
+    signature = sha256_hex("");
+}
+
+bool IgnoreMatcher::add_pattern(const std::string& line) {
+    std::string text = line;
+
+    // Trailing whitespace is dropped unless escaped
+    while (!text.empty() && (text.back() == '\r' || text.back() == ' ' || text.back() == '\t')) {
+        if (text.back() == ' ' && text.size() > 1 && text[text.size() - 2] == '\\') {
+            break;
+        }
+        text.pop_back();
+    }
+    if (text.empty() || text[0] == '#') {
+        return false;
+    }
+
+    IgnorePattern pattern;
+    if (text[0] == '!') {
+        pattern.negated = true;
+        text.erase(0, 1);
+    }
+    if (!text.empty() && text.back() == '/') {
+        pattern.directory_only = true;
+        text.pop_back();
+    }
+    if (!text.empty() && text[0] == '/') {
+        pattern.anchored = true;
+        text.erase(0, 1);
+    } else if (text.find('/') != std::string::npos) {
+        pattern.anchored = true;
+    }
+    if (text.empty()) {
+        return false;
+    }
+
+    // Pick the cheapest way to match this pattern
+    const char* wildcards = "*?[\\";
+    size_t first_wild = text.find_first_of(wildcards);
+    if (first_wild == std::string::npos) {
+        pattern.kind = IgnorePattern::Kind::LITERAL;
+        pattern.text = text;
+    } else if (text[0] == '*' && text.size() > 1 &&
+               text.find_first_of(wildcards, 1) == std::string::npos &&
+               text.find('/') == std::string::npos) {
+        pattern.kind = IgnorePattern::Kind::SUFFIX;
+        pattern.text = text.substr(1);
+    } else if (first_wild == text.size() - 1 && text.back() == '*' && first_wild > 0) {
+        pattern.kind = IgnorePattern::Kind::PREFIX;
+        pattern.text = text.substr(0, first_wild);
+    } else {
+        pattern.kind = IgnorePattern::Kind::GLOB;
+        if (!compile_glob(text, pattern.glob)) {
+            std::cerr << "Warning: Ignoring overly long .ggignore pattern '" << line << "'" << std::endl;
+            return false;
+        }
+    }
+
+    patterns.push_back(pattern);
+    return true;
+}
+
+bool IgnoreMatcher::load(const std::string& filepath) {
+    patterns.clear();
+    std::string contents = read_file_contents(filepath);
+    signature = sha256_hex(contents);
+
+    std::istringstream stream(contents);
+    std::string line;
+    while (std::getline(stream, line)) {
+        add_pattern(line);
+    }
+    return !contents.empty();
+}
+
+bool IgnoreMatcher::empty() const {
+    return patterns.empty();
+}
+
+const std::string& IgnoreMatcher::get_signature() const {
+    return signature;
+}
+
+bool IgnoreMatcher::matches(const std::string& path, bool is_dir) const {
+    size_t slash = path.rfind('/');
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    // Later patterns override earlier ones
+    for (auto it = patterns.rbegin(); it != patterns.rend(); ++it) {
+        if (it->directory_only && !is_dir) {
+            continue;
+        }
+        if (it->matches(path, name)) {
+            return !it->negated;
+        }
+    }
+    return false;
+}
+
+void IgnoreMatcher::set_worker_count(size_t count) {
+    seen.resize(std::max<size_t>(count, 1));
+}
+
+bool IgnoreMatcher::is_ignored(const std::string& path, bool is_dir, size_t worker) {
+    if (patterns.empty()) {
+        return false;
+    }
+    if (!is_dir) {
+        return matches(path, false);
+    }
+
+    auto cached = cached_dirs.find(path);
+    bool from_cache = cached != cached_dirs.end();
+    bool ignored = from_cache ? cached->second : matches(path, true);
+
+    SeenDirs& mine = seen[worker];
+    mine.dirs[path] = ignored;
+    if (!from_cache) {
+        mine.changed = true;
+    }
+    return ignored;
+}
+
+bool IgnoreMatcher::is_path_ignored(const std::string& path, size_t worker) {
+    for (size_t slash = path.find('/'); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        if (is_ignored(path.substr(0, slash), true, worker)) {
+            return true;
+        }
+    }
+    return is_ignored(path, false, worker);
+}
+
+bool IgnoreMatcher::load_cache(const std::string& filepath) {
+    cached_dirs.clear();
+
+    std::string data = read_file_contents(filepath);
+    BinaryReader reader(data);
+    if (!reader.read_header("GGIG") || reader.read_string() != signature) {
+        return false;
+    }
+
+    uint32_t count = reader.read_u32();
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        std::string dir = reader.read_string();
+        bool ignored = reader.read_u8() != 0;
+        cached_dirs[dir] = ignored;
+    }
+    if (!reader.ok()) {
+        cached_dirs.clear();
+        return false;
+    }
+    return true;
+}
+
+bool IgnoreMatcher::save_cache(const std::string& filepath) {
+    // Merge the per-worker results once the walk is over
+    std::unordered_map<std::string, bool> seen_dirs;
+    bool changed = false;
+    for (auto& worker : seen) {
+        seen_dirs.insert(worker.dirs.begin(), worker.dirs.end());
+        changed |= worker.changed;
+    }
+
+    // Rewrite only when a directory was added or one disappeared
+    if (patterns.empty() || (!changed && seen_dirs.size() == cached_dirs.size())) {
+        return true;
+    }
+
+    BinaryWriter writer;
+    writer.write_header("GGIG");
+    writer.write_string(signature);
+    writer.write_u32(static_cast<uint32_t>(seen_dirs.size()));
+    for (const auto& [dir, ignored] : seen_dirs) {
+        writer.write_string(dir);
+        writer.write_u8(ignored ? 1 : 0);
+    }
+    return write_file_contents(filepath, writer.data());
+}
@@ -0,0 +1,201 @@
+/**
+ * index.cpp - Binary staging index with a stat cache
+ *
+ * Implements the stat comparison and "racy clean" handling: an entry whose
+ * mtime is not older than the index file itself may have been modified
+ * within the same timestamp tick as the index write, so its contents are
+ * always rehashed instead of trusting the stat data.
+ */
+
+#include "../include/index.h"
+#include "../include/objects.h"
+#include "../include/serial.h"
+#include "../include/hash.h"
+#include "../include/gg.h"
+#include <sys/stat.h>
+
+static int64_t stat_mtime_ns(const struct stat& st) {
+#if defined(__APPLE__)
+    return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(_WIN32) && !defined(__CYGWIN__)
+    return static_cast<int64_t>(st.st_mtime) * 1000000000;
+#else
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+// StagingIndex implementation
+StagingIndex::StagingIndex() : index_mtime_ns(0), dirty(false) {
+}
+
+bool StagingIndex::stat_file(const std::string& path, IndexEntry& entry) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    entry.size = static_cast<uint64_t>(st.st_size);
+    entry.mtime_ns = stat_mtime_ns(st);
+    entry.inode = static_cast<uint64_t>(st.st_ino);
+    entry.mode = static_cast<uint32_t>(st.st_mode);
+    return true;
+}
+
+bool StagingIndex::is_racily_clean(const IndexEntry& entry) const {
+    return index_mtime_ns == 0 || entry.mtime_ns >= index_mtime_ns;
+}
+
+bool StagingIndex::update(const std::string& path, const std::string& blob_id) {
+    IndexEntry entry;
+    entry.path = path;
+    entry.blob_id = blob_id;
+    if (!stat_file(path, entry)) {
+        return false;
+    }
+    entries[path] = entry;
+    dirty = true;
+    return true;
+}
+
+bool StagingIndex::remove(const std::string& path) {
+    if (entries.erase(path) == 0) {
+        return false;
+    }
+    dirty = true;
+    return true;
+}
+
+const IndexEntry* StagingIndex::find(const std::string& path) const {
+    auto it = entries.find(path);
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+size_t StagingIndex::size() const {
+    return entries.size();
+}
+
+bool StagingIndex::check_modified(const std::string& path, ObjectStore& store) {
+    auto it = entries.find(path);
+    if (it == entries.end()) {
+        return false;
+    }
+    IndexEntry& entry = it->second;
+    
+    IndexEntry current;
+    if (!stat_file(path, current)) {
+        return true; // Deleted or unreadable
+    }
+    
+    // A size or mode change is a modification without reading the file; a
+    // zero size may be an entry smudged by save(), so it is not conclusive
+    if (current.mode != entry.mode || (entry.size != 0 && current.size != entry.size)) {
+        return true;
+    }
+    
+    // Matching stat data is trusted unless the entry is racily clean or smudged
+    bool stat_matches = current.size == entry.size && current.mtime_ns == entry.mtime_ns && current.inode == entry.inode;
+    if (stat_matches && entry.size != 0 && !is_racily_clean(entry)) {
+        return false;
+    }
+    
+    // Same size, different (or untrustworthy) timestamps: compare contents
+    std::string blob_id = store.hash_blob_from_file(path);
+    if (blob_id != entry.blob_id) {
+        return true;
+    }
+    
+    // Contents unchanged: refresh the stat data so the next check is cheap
+    if (!stat_matches) {
+        entry.size = current.size;
+        entry.mtime_ns = current.mtime_ns;
+        entry.inode = current.inode;
+        dirty = true;
+    }
+    return false;
+}
+
+bool StagingIndex::is_dirty() const {
+    return dirty;
+}
+
+std::string StagingIndex::serialize() const {
+    BinaryWriter writer;
+    writer.write_header("GGIX");
+    writer.write_u32(static_cast<uint32_t>(entries.size()));
+    for (const auto& [path, entry] : entries) {
+        writer.write_string(path);
+        std::string raw_id = hex_to_bytes(entry.blob_id);
+        raw_id.resize(32, '\0');
+        writer.write_bytes(raw_id.data(), raw_id.size());
+        writer.write_u64(entry.size);
+        writer.write_u64(static_cast<uint64_t>(entry.mtime_ns));
+        writer.write_u64(entry.inode);
+        writer.write_u32(entry.mode);
+    }
+    return writer.data();
+}
+
+StagingIndex StagingIndex::deserialize(const std::string& data) {
+    StagingIndex index;
+    BinaryReader reader(data);
+    if (!reader.read_header("GGIX")) {
+        return index;
+    }
+    
+    uint32_t count = reader.read_u32();
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        IndexEntry entry;
+        entry.path = reader.read_string();
+        entry.blob_id = bytes_to_hex(reader.read_bytes(32));
+        entry.size = reader.read_u64();
+        entry.mtime_ns = static_cast<int64_t>(reader.read_u64());
+        entry.inode = reader.read_u64();
+        entry.mode = reader.read_u32();
+        if (reader.ok()) {
+            index.entries[entry.path] = entry;
+        }
+    }
+    return index;
+}
+
+StagingIndex StagingIndex::load(const std::string& filepath) {
+    StagingIndex index = deserialize(read_file_contents(filepath));
+    
+    struct stat st;
+    if (stat(filepath.c_str(), &st) == 0) {
+        index.index_mtime_ns = stat_mtime_ns(st);
+    }
+    return index;
+}
+
+bool StagingIndex::save(const std::string& filepath) {
+    if (!write_file_contents(filepath, serialize())) {
+        return false;
+    }
+    
+    struct stat st;
+    if (stat(filepath.c_str(), &st) != 0) {
+        return false;
+    }
+    index_mtime_ns = stat_mtime_ns(st);
+    
+    // An entry stamped no earlier than the index could still be edited
+    // without its size or mtime changing. Smudge its size, as git does, so
+    // the next check compares contents instead of trusting the stat data.
+    bool smudged = false;
+    for (auto& [path, entry] : entries) {
+        if (entry.size != 0 && entry.mtime_ns >= index_mtime_ns) {
+            entry.size = 0;
+            smudged = true;
+        }
+    }
+    if (smudged) {
+        if (!write_file_contents(filepath, serialize())) {
+            return false;
+        }
+        if (stat(filepath.c_str(), &st) == 0) {
+            index_mtime_ns = stat_mtime_ns(st);
+        }
+    }
+    dirty = false;
+    return true;
+}
@@ -8,14 +8,23 @@
 #include "../include/gg.h"
 #include "../include/trie.h"
 #include "../include/dag.h"
+#include "../include/generation.h"
+#include "../include/reachability.h"
 #include "../include/avl.h"
+#include "../include/refs.h"
+#include "../include/reflog.h"
 #include "../include/skiplist.h"
 #include "../include/disjoint.h"
-#include "../include/bloom.h"
+#include "../include/cuckoo.h"
+#include "../include/serial.h"
+#include "../include/objects.h"
+#include "../include/index.h"
 #include <iostream>
 #include <filesystem>
 #include <fstream>
 #include <ctime>
+#include <cstring>
+#include <cerrno>
 #include <random>
 #include <ncurses.h>
 
@@ -41,9 +50,6 @@ bool init_repository() {
         return false;
     }
     
-    // Initialize UI
-    init_ui();
-    
     // Create the .gg directory and subdirectories
     try {
         fs::create_directory(".gg");
@@ -51,7 +57,6 @@ bool init_repository() {
         fs::create_directory(".gg/refs");
         fs::create_directory(".gg/refs/heads");
     } catch (const std::exception& e) {
-        cleanup_ui();
         std::cerr << "Error creating repository: " << e.what() << std::endl;
         return false;
     }
@@ -61,18 +66,22 @@ bool init_repository() {
     
     // Create initial commit (root)
     Commit initial_commit;
-    initial_commit.id = generate_commit_id();
     initial_commit.message = "Initial commit";
     initial_commit.author = "gg";
     initial_commit.timestamp = get_current_time_string();
+    initial_commit.id = ObjectStore().write_commit(initial_commit);
     
     // Initialize data structures
     repo.file_trie = std::make_shared<Trie>();
     repo.commit_graph = std::make_shared<DAG>();
+    repo.generations = std::make_shared<GenerationIndex>();
+    repo.reachability = std::make_shared<ReachabilityIndex>();
     repo.branches = std::make_shared<AVLTree>();
+    repo.refs = std::make_shared<RefStore>();
     repo.commit_list = std::make_shared<SkipList>();
     repo.merge_sets = std::make_shared<DisjointSet>();
-    repo.file_filter = std::make_shared<BloomFilter>();
+    repo.file_filter = std::make_shared<CuckooFilter>(CuckooFilter::DEFAULT_CAPACITY, GGRepo::FILE_FILTER_TARGET_FPR);
+    repo.index = std::make_shared<StagingIndex>();
     
     // Add initial commit to DAG
     repo.commit_graph->add_commit(initial_commit, {});
@@ -82,12 +91,26 @@ bool init_repository() {
     BranchInfo main_branch("main", initial_commit.id, initial_commit.timestamp);
     repo.branches->insert(main_branch);
     repo.current_branch = "main";
+    repo.log_branch_move("main", "", initial_commit.id, "bruh: Initial commit");
+    repo.log_head_move("", initial_commit.id, "bruh: Initial commit");
     
     // Add commit to skip list for traversal
     repo.commit_list->insert(initial_commit.id, initial_commit.timestamp);
     
     // Save repository state
-    repo.save();
+    if (!repo.save()) {
+        return false;
+    }
+    
+    // Headless mode: report and skip the visualization
+    if (is_headless_mode()) {
+        std::cout << "[gg] Repository initialized." << std::endl;
+        std::cout << "Initial commit: " << initial_commit.id << std::endl;
+        return true;
+    }
+    
+    // Initialize UI
+    init_ui();
     
     // Create a visualization of the newly initialized repository
     clear();
@@ -127,12 +150,12 @@ bool init_repository() {
     
     row += 9;
     
-    // Draw empty bloom filter
-    WINDOW* bloom_win = newwin(8, 40, row, col);
-    box(bloom_win, 0, 0);
-    mvwprintw(bloom_win, 0, 2, " File Existence (Bloom Filter) ");
-    repo.file_filter->draw(bloom_win, 1, 2, 36, 6);
-    wrefresh(bloom_win);
+    // Draw empty cuckoo filter
+    WINDOW* filter_win = newwin(8, 40, row, col);
+    box(filter_win, 0, 0);
+    mvwprintw(filter_win, 0, 2, " File Existence (Cuckoo Filter) ");
+    repo.file_filter->draw(filter_win, 1, 2, 36, 6);
+    wrefresh(filter_win);
     
     // Display success message and a quip
     attron(COLOR_PAIR(COLOR_SUCCESS));
@@ -150,7 +173,7 @@ bool init_repository() {
     delwin(dag_win);
     delwin(avl_win);
     delwin(trie_win);
-    delwin(bloom_win);
+    delwin(filter_win);
     cleanup_ui();
     
     return true;
@@ -161,22 +184,6 @@ bool init_command(int argc, char* argv[]) {
     return init_repository();
 }
 
-// Generate a random commit ID (for fun, similar to git's hashes)
-std::string generate_commit_id() {
-    static const char hex_chars[] = "0123456789abcdef";
-    static std::mt19937 rng{std::random_device{}()};
-    static std::uniform_int_distribution<size_t> dist{0, 15};
-    
-    std::string id;
-    id.reserve(8);
-    
-    for (int i = 0; i < 8; ++i) {
-        id += hex_chars[dist(rng)];
-    }
-    
-    return id;
-}
-
 // Get current time as formatted string
 std::string get_current_time_string() {
     auto now = std::time(nullptr);
@@ -186,6 +193,17 @@ std::string get_current_time_string() {
     return std::string(buffer);
 }
 
+// Whether the UI runs headless (no initscr, no animation, no getch)
+static bool headless_mode = false;
+
+void set_headless_mode(bool headless) {
+    headless_mode = headless;
+}
+
+bool is_headless_mode() {
+    return headless_mode;
+}
+
 // Initialize ncurses UI
 void init_ui() {
     initscr();
@@ -261,14 +279,181 @@ bool GGRepo::exists() const {
     return fs::exists(".gg");
 }
 
+// Each data structure lives in its own binary file under .gg/
+static const char* HEAD_FILE = ".gg/HEAD";
+static const char* TRIE_FILE = ".gg/trie";
+static const char* DAG_FILE = ".gg/dag";
+static const char* COMMIT_GRAPH_FILE = ".gg/commit-graph";
+static const char* BITMAPS_FILE = ".gg/bitmaps";
+static const char* SKIPLIST_FILE = ".gg/skiplist";
+static const char* DISJOINT_FILE = ".gg/disjoint";
+static const char* FILTER_FILE = ".gg/filter";
+
+// Commits the branches point at, which get their own reachability bitmaps
+static std::vector<CommitIndex> branch_tips(const GGRepo& repo) {
+    std::vector<CommitIndex> tips;
+    for (const auto& commit_id : repo.branches->get_branch_commits()) {
+        tips.push_back(repo.commit_graph->find(commit_id));
+    }
+    return tips;
+}
+
 GGRepo GGRepo::load() {
-    // Placeholder for loading repository state from disk
     GGRepo repo;
-    // This would deserialize all data structures from .gg directory
+    
+    // Missing files load as empty structures, so a fresh repo always works
+    std::string head_data = read_file_contents(HEAD_FILE);
+    BinaryReader head_reader(head_data);
+    if (head_reader.read_header("GGHD")) {
+        repo.current_branch = head_reader.read_string();
+        repo.head_commit = head_reader.read_string();
+        repo.saved_head = head_data;
+    }
+    
+    repo.file_trie = std::make_shared<Trie>(Trie::deserialize(read_file_contents(TRIE_FILE)));
+    repo.commit_graph = std::make_shared<DAG>(DAG::deserialize(read_file_contents(DAG_FILE)));
+    repo.generations = std::make_shared<GenerationIndex>(GenerationIndex::deserialize(read_file_contents(COMMIT_GRAPH_FILE)));
+    repo.generations->update(*repo.commit_graph);
+    repo.refs = std::make_shared<RefStore>();
+    repo.branches = std::make_shared<AVLTree>(repo.refs->load());
+    repo.commit_list = std::make_shared<SkipList>(SkipList::deserialize(read_file_contents(SKIPLIST_FILE)));
+    repo.merge_sets = std::make_shared<DisjointSet>(DisjointSet::deserialize(read_file_contents(DISJOINT_FILE)));
+    repo.file_filter = std::make_shared<CuckooFilter>(CuckooFilter::deserialize(read_file_contents(FILTER_FILE)));
+    repo.reachability = std::make_shared<ReachabilityIndex>(ReachabilityIndex::deserialize(read_file_contents(BITMAPS_FILE)));
+    repo.reachability->update(*repo.commit_graph, branch_tips(repo));
+    
+    // The filter must never miss a tracked path; if it is missing, from an
+    // older format, or out of step with the Trie, rebuild it from the Trie.
+    // Rebuild too if it was sized for a looser target than the current one.
+    if (repo.file_filter->get_item_count() != repo.file_trie->size() ||
+        repo.file_filter->false_positive_probability() > GGRepo::FILE_FILTER_TARGET_FPR) {
+        repo.rebuild_file_filter();
+    }
+    repo.index = std::make_shared<StagingIndex>(StagingIndex::load());
+    
     return repo;
 }
 
-void GGRepo::save() const {
-    // Placeholder for saving repository state to disk
-    // This would serialize all data structures to .gg directory
+// Rewrite one structure's file if it changed; it stays dirty on failure
+template <typename Structure>
+static bool save_if_dirty(Structure& structure, const char* filepath) {
+    if (!structure.is_dirty()) {
+        return true;
+    }
+    if (!write_file_contents(filepath, structure.serialize())) {
+        return false;
+    }
+    structure.clear_dirty();
+    return true;
+}
+
+// Writes only the structures changed since load() or the last save(), so a
+// command costs what it changed rather than the size of the repository.
+// Returns false if any part of the state could not be written.
+bool GGRepo::save() {
+    BinaryWriter head_writer;
+    head_writer.write_header("GGHD");
+    head_writer.write_string(current_branch);
+    head_writer.write_string(head_commit);
+    bool saved = true;
+    if (head_writer.data() != saved_head) {
+        if (write_file_contents(HEAD_FILE, head_writer.data())) {
+            saved_head = head_writer.data();
+        } else {
+            saved = false;
+        }
+    }
+    
+    saved &= save_if_dirty(*file_trie, TRIE_FILE);
+    saved &= save_if_dirty(*commit_graph, DAG_FILE);
+    generations->update(*commit_graph);
+    saved &= save_if_dirty(*generations, COMMIT_GRAPH_FILE);
+    saved &= refs->save(*branches);
+    reachability->update(*commit_graph, branch_tips(*this));
+    saved &= save_if_dirty(*reachability, BITMAPS_FILE);
+    saved &= save_if_dirty(*commit_list, SKIPLIST_FILE);
+    saved &= save_if_dirty(*merge_sets, DISJOINT_FILE);
+    saved &= save_if_dirty(*file_filter, FILTER_FILE);
+    if (index->is_dirty()) {
+        saved &= index->save();
+    }
+    
+    // A reflog must never name a state that was not written, so movements
+    // are logged only after everything else is saved
+    if (!saved) {
+        return false;
+    }
+    for (const auto& move : ref_moves) {
+        Reflog log = move.branch.empty() ? Reflog::for_head() : Reflog::for_branch(move.branch);
+        if (!log.append(move.old_id, move.new_id, move.reason)) {
+            std::cerr << "Error: Could not write the reflog of "
+                      << (move.branch.empty() ? "HEAD" : move.branch) << std::endl;
+            saved = false;
+        }
+    }
+    ref_moves.clear();
+    return saved;
+}
+
+void GGRepo::log_head_move(const std::string& old_id, const std::string& new_id, const std::string& reason) {
+    ref_moves.push_back({"", old_id, new_id, reason});
+}
+
+void GGRepo::log_branch_move(const std::string& branch, const std::string& old_id,
+                             const std::string& new_id, const std::string& reason) {
+    ref_moves.push_back({branch, old_id, new_id, reason});
+}
+
+// Refill the filter from the Trie, sized for the target rate with room for
+// the tree to double
+void GGRepo::rebuild_file_filter() {
+    size_t capacity = std::max<size_t>(CuckooFilter::DEFAULT_CAPACITY, file_trie->size() * 2);
+    file_filter = std::make_shared<CuckooFilter>(capacity, FILE_FILTER_TARGET_FPR);
+    file_trie->for_each_file([this](const std::string& path, FileStatus) {
+        file_filter->add(path);
+        return true;
+    });
+}
+
+bool file_exists(const std::string& filepath) {
+    return fs::exists(filepath);
+}
+
+// Read a whole file with a single sequential read; missing files read as empty
+std::string read_file_contents(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return std::string();
+    }
+    
+    std::string contents(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(&contents[0], contents.size());
+    return contents;
+}
+
+// Write a file atomically: write a temporary sibling, then rename over the target
+bool write_file_contents(const std::string& filepath, const std::string& contents) {
+    std::string temp_path = filepath + ".tmp";
+    bool written;
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), contents.size());
+        file.close();
+        written = static_cast<bool>(file);
+    }
+    
+    std::error_code ec;
+    if (!written) {
+        std::cerr << "Error writing " << filepath << ": " << std::strerror(errno) << std::endl;
+        fs::remove(temp_path, ec);
+        return false;
+    }
+    fs::rename(temp_path, filepath, ec);
+    if (ec) {
+        fs::remove(temp_path, ec);
+        std::cerr << "Error writing " << filepath << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
 }
@@ -10,9 +10,13 @@
 #include "../include/dag.h"
 #include "../include/skiplist.h"
 #include "../include/avl.h"
+#include "../include/objects.h"
+#include "../include/index.h"
+#include "../include/pathindex.h"
 #include <iostream>
 #include <filesystem>
 #include <sstream>
+#include <cstring>
 #include <ncurses.h>
 
 namespace fs = std::filesystem;
@@ -29,6 +33,54 @@ const std::vector<std::string> QuipGenerator::commit_quips = {
     "Commit successful. Pretending we understand the code we just wrote."
 };
 
+// Build the commit for the staged files and advance HEAD, the current
+// branch and the skip list to it
+static Commit record_commit(GGRepo& repo, const std::string& message,
+                            const std::vector<std::string>& staged_files) {
+    ObjectStore store;
+    
+    // Create a new commit
+    Commit new_commit;
+    new_commit.message = message;
+    new_commit.author = "gg"; // In a real implementation, this would be configurable
+    new_commit.timestamp = get_current_time_string();
+    new_commit.parent_ids.push_back(repo.head_commit);
+    
+    for (const auto& file : staged_files) {
+        // Commit the blob recorded at staging time; files staged before the
+        // index existed are stored now
+        const IndexEntry* entry = repo.index->find(file);
+        std::string blob_id = entry ? entry->blob_id : store.write_blob_from_file(file);
+        if (!blob_id.empty()) {
+            new_commit.file_snapshots[file] = blob_id;
+        }
+        
+        // Update file status in trie
+        repo.file_trie->update_status(file, FileStatus::COMMITTED);
+    }
+    
+    // The commit ID is the hash of the stored commit object
+    new_commit.id = store.write_commit(new_commit);
+    
+    // Add new commit to DAG, with its changed-path filter alongside
+    repo.commit_graph->add_commit(new_commit, {repo.head_commit});
+    ChangedPathIndex::append(new_commit);
+    repo.head_commit = new_commit.id;
+    
+    // Update current branch to point to new commit
+    repo.branches->update_commit(repo.current_branch, new_commit.id, new_commit.timestamp);
+    
+    // Record the move in the branch's and HEAD's reflogs
+    std::string reason = "kermit: " + message;
+    repo.log_branch_move(repo.current_branch, new_commit.parent_ids[0], new_commit.id, reason);
+    repo.log_head_move(new_commit.parent_ids[0], new_commit.id, reason);
+    
+    // Add commit to skip list
+    repo.commit_list->insert(new_commit.id, new_commit.timestamp);
+    
+    return new_commit;
+}
+
 // Create a new commit with staged changes
 bool commit_changes(const std::string& message) {
     // Check if we're in a gg repository
@@ -47,6 +99,17 @@ bool commit_changes(const std::string& message) {
         return false;
     }
     
+    // Headless mode: commit and report in plain text
+    if (is_headless_mode()) {
+        Commit new_commit = record_commit(repo, message, staged_files);
+        if (!repo.save()) {
+            return false;
+        }
+        std::cout << "[gg] Kermit successful: \"" << message << "\"" << std::endl;
+        std::cout << "Commit ID: " << new_commit.id << std::endl;
+        return true;
+    }
+    
     // Initialize UI
     init_ui();
     clear();
@@ -59,17 +122,6 @@ bool commit_changes(const std::string& message) {
     mvprintw(2, 2, "Message: \"%s\"", message.c_str());
     attroff(COLOR_PAIR(COLOR_DEFAULT));
     
-    // Generate a new commit ID
-    std::string commit_id = generate_commit_id();
-    
-    // Create a new commit
-    Commit new_commit;
-    new_commit.id = commit_id;
-    new_commit.message = message;
-    new_commit.author = "gg"; // In a real implementation, this would be configurable
-    new_commit.timestamp = get_current_time_string();
-    new_commit.parent_ids.push_back(repo.head_commit);
-    
     // Draw current DAG (before update)
     int row = 5;
     int col = 2;
@@ -89,32 +141,19 @@ bool commit_changes(const std::string& message) {
     repo.commit_list->draw(skip_before_win, 1, 2);
     wrefresh(skip_before_win);
     
-    // Add staged files to commit
+    // Create the commit from the staged files
+    Commit new_commit = record_commit(repo, message, staged_files);
+    std::string commit_id = new_commit.id;
+    
+    // List the staged files that went into the commit
     attron(COLOR_PAIR(COLOR_STAGED));
     mvprintw(3, 2, "Staged files:");
     int file_row = 4;
     for (const auto& file : staged_files) {
         mvprintw(file_row++, 4, "- %s", file.c_str());
-        
-        // In a real implementation, we would calculate file content hashes
-        // and store them in the commit's file_snapshots map
-        new_commit.file_snapshots[file] = "dummy_hash_" + file;
-        
-        // Update file status in trie
-        repo.file_trie->update_status(file, FileStatus::COMMITTED);
     }
     attroff(COLOR_PAIR(COLOR_STAGED));
     
-    // Add new commit to DAG
-    repo.commit_graph->add_commit(new_commit, {repo.head_commit});
-    repo.head_commit = commit_id;
-    
-    // Update current branch to point to new commit
-    repo.branches->update_commit(repo.current_branch, commit_id, new_commit.timestamp);
-    
-    // Add commit to skip list
-    repo.commit_list->insert(commit_id, new_commit.timestamp);
-    
     // Column for "after" panels
     col += 52;
     row = 5;
@@ -145,7 +184,10 @@ bool commit_changes(const std::string& message) {
     }
     
     // Save repository state
-    repo.save();
+    if (!repo.save()) {
+        cleanup_ui();
+        return false;
+    }
     
     // Display success message and quip
     attron(COLOR_PAIR(COLOR_SUCCESS));
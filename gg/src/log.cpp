@@ -1,18 +1,26 @@
 /**
  * log.cpp - Implementation of the 'gg log' command
  * 
- * Displays the commit history by traversing the DAG using BFS,
- * with Skip List for efficient navigation.
+ * Displays the commit history newest first with a lazy revision walk,
+ * fetching commits only as they scroll into view. A range "<base>..<tip>"
+ * shows only the commits tip has and base lacks, read off the difference
+ * of their reachability bitmaps.
  */
 
 #include "../include/gg.h"
 #include "../include/dag.h"
 #include "../include/skiplist.h"
 #include "../include/avl.h"
+#include "../include/pathindex.h"
+#include "../include/generation.h"
+#include "../include/revwalk.h"
+#include "../include/reachability.h"
+#include "../include/reflog.h"
+#include "../include/serial.h"
 #include <iostream>
 #include <filesystem>
 #include <vector>
-#include <queue>
+#include <algorithm>
 #include <ncurses.h>
 
 namespace fs = std::filesystem;
@@ -29,8 +37,83 @@ const std::vector<std::string> QuipGenerator::log_quips = {
     "Ah, the paper trail of panic and confusion. Beautiful, isn't it?"
 };
 
-// Show commit history
-void show_log() {
+// Draw one 4-row log entry at a window row, clipped to the window's interior
+static void draw_log_entry(WINDOW* win, int row, const GGRepo& repo, const Commit& commit, bool has_more) {
+    int rows = getmaxy(win) - 1;
+    int width = getmaxx(win) - 3;
+    auto put = [&](int line, int col, const std::string& text) {
+        if (row + line >= 1 && row + line < rows && col < width) {
+            mvwaddnstr(win, row + line, col + 1, text.c_str(), width - col);
+        }
+    };
+    
+    // Check if this is the current HEAD
+    bool is_head = (commit.id == repo.head_commit);
+    
+    // Find which branches point to this commit
+    std::vector<std::string> branches_on_commit = repo.branches->branches_at(commit.id);
+    
+    // Commit ID and message, with HEAD and the branches pointing here
+    std::string title = "* " + commit.id + " - \"" + commit.message + "\"";
+    if (!branches_on_commit.empty()) {
+        title += " (";
+        if (is_head) {
+            title += "HEAD -> ";
+        }
+        for (size_t i = 0; i < branches_on_commit.size(); ++i) {
+            title += branches_on_commit[i];
+            if (i < branches_on_commit.size() - 1) {
+                title += ", ";
+            }
+        }
+        title += ")";
+    } else if (is_head) {
+        title += " (HEAD)";
+    }
+    
+    int title_color = is_head ? COLOR_HIGHLIGHT : COLOR_COMMIT;
+    wattron(win, COLOR_PAIR(title_color));
+    put(0, 0, title);
+    wattroff(win, COLOR_PAIR(title_color));
+    
+    // Display commit details
+    wattron(win, COLOR_PAIR(COLOR_DEFAULT));
+    put(1, 4, "Author: " + commit.author);
+    put(2, 4, "Date: " + commit.timestamp);
+    
+    // Draw connection line to the next entry
+    if (has_more) {
+        put(3, 0, " |");
+    }
+    
+    // Display parent commit IDs
+    if (!commit.parent_ids.empty()) {
+        std::string parents = "Parents: ";
+        for (size_t i = 0; i < commit.parent_ids.size(); ++i) {
+            parents += commit.parent_ids[i];
+            if (i < commit.parent_ids.size() - 1) {
+                parents += ", ";
+            }
+        }
+        put(3, 4, parents);
+    }
+    wattroff(win, COLOR_PAIR(COLOR_DEFAULT));
+}
+
+// Branch name or commit id; empty means HEAD
+static CommitIndex resolve_revision(const GGRepo& repo, const std::string& revision) {
+    if (revision.empty()) {
+        return repo.commit_graph->find(repo.head_commit);
+    }
+    if (const BranchInfo* branch = repo.branches->find(revision)) {
+        return repo.commit_graph->find(branch->commit_id);
+    }
+    return repo.commit_graph->find(revision);
+}
+
+// Show commit history, optionally only the commits that changed path
+// and only those in a "<base>..<tip>" range
+void show_log(const std::string& path, const std::string& range) {
     // Check if we're in a gg repository
     if (!fs::exists(".gg")) {
         std::cerr << "Error: Not a gg repository (or any of the parent directories)" << std::endl;
@@ -39,35 +122,83 @@ void show_log() {
     
     // Load repository state
     GGRepo repo = GGRepo::load();
+    const DAG& graph = *repo.commit_graph;
     
-    // Initialize UI
-    init_ui();
-    clear();
+    // Walk newest first from HEAD and every branch tip; commits are only
+    // fetched as they are about to be shown
+    RevisionWalker walker(graph, *repo.generations);
+    walker.push(graph.find(repo.head_commit));
+    for (const auto& commit_id : repo.branches->get_branch_commits()) {
+        walker.push(graph.find(commit_id));
+    }
     
-    // Display header
-    display_header("Commit History");
+    // A range is one bitmap difference. Parents always have smaller
+    // indices, so taking the result from the back is newest first.
+    std::vector<CommitIndex> range_commits;
+    if (!range.empty()) {
+        size_t dots = range.find("..");
+        CommitIndex base = resolve_revision(repo, range.substr(0, dots));
+        CommitIndex tip = resolve_revision(repo, range.substr(dots + 2));
+        if (base == NO_COMMIT || tip == NO_COMMIT) {
+            std::cerr << "Error: Unknown revision in range '" << range << "'" << std::endl;
+            return;
+        }
+        range_commits = repo.reachability->difference(graph, tip, base);
+    }
+    auto next_candidate = [&]() -> CommitIndex {
+        if (range.empty()) {
+            return walker.next();
+        }
+        if (range_commits.empty()) {
+            return NO_COMMIT;
+        }
+        CommitIndex index = range_commits.back();
+        range_commits.pop_back();
+        return index;
+    };
     
-    // Get commit history using BFS
-    std::vector<std::shared_ptr<DAGNode>> commits = repo.commit_graph->breadth_first_search();
+    // Path-limited history: each commit's changed-path filter rules most
+    // commits out, and only possible hits are checked against the snapshot
+    std::string pathspec = path;
+    if (pathspec.compare(0, 2, "./") == 0) {
+        pathspec.erase(0, 2);
+    }
+    while (!pathspec.empty() && pathspec.back() == '/') {
+        pathspec.pop_back();
+    }
+    ChangedPathIndex path_index;
+    if (!pathspec.empty()) {
+        path_index.load();
+    }
     
-    // Prepare for scrollable window
-    int max_row = 5;
-    int max_col = 2;
-    int win_height = LINES - 8;
-    int win_width = COLS - 4;
+    auto next_commit = [&]() {
+        for (CommitIndex index = next_candidate(); index != NO_COMMIT; index = next_candidate()) {
+            const Commit& commit = graph.commit_at(index);
+            if (pathspec.empty() ||
+                (path_index.might_change(commit.id, pathspec) && ChangedPathIndex::changes(commit, pathspec))) {
+                return index;
+            }
+        }
+        return NO_COMMIT;
+    };
     
-    // Create window for scrollable commit history
-    WINDOW* pad = newpad(commits.size() * 4 + 2, win_width);
+    // Headless mode: one "<id> <timestamp> <message>" line per commit,
+    // written as the walk produces them
+    if (is_headless_mode()) {
+        for (CommitIndex index = next_commit(); index != NO_COMMIT; index = next_commit()) {
+            const Commit& commit = graph.commit_at(index);
+            std::cout << commit.id << " " << commit.timestamp << " " << commit.message << "\n";
+        }
+        std::cout.flush();
+        return;
+    }
     
-    // Draw DAG
-    WINDOW* dag_win = newwin(LINES - max_row - 3, win_width, max_row, max_col);
-    box(dag_win, 0, 0);
-    mvwprintw(dag_win, 0, 2, " Commit Graph (DAG) ");
-    repo.commit_graph->draw(dag_win, repo.head_commit);
-    wrefresh(dag_win);
+    // Initialize UI
+    init_ui();
+    clear();
     
-    // Move to next row for log
-    max_row += LINES - max_row - 2;
+    // Display header
+    display_header("Commit History");
     
     // Display branch and commit info
     attron(COLOR_PAIR(COLOR_BRANCH));
@@ -75,123 +206,67 @@ void show_log() {
     attroff(COLOR_PAIR(COLOR_BRANCH));
     
     attron(COLOR_PAIR(COLOR_DEFAULT));
-    mvprintw(3, 2, "Commit history (newest first):");
-    attroff(COLOR_PAIR(COLOR_DEFAULT));
-    
-    // Draw commit history in the pad
-    int pad_row = 0;
-    for (const auto& commit_node : commits) {
-        const Commit& commit = commit_node->commit;
-        
-        // Check if this is the current HEAD
-        bool is_head = (commit.id == repo.head_commit);
-        
-        // Find which branches point to this commit
-        std::vector<std::string> branches_on_commit;
-        std::vector<BranchInfo> all_branches = repo.branches->get_all_branches();
-        for (const auto& branch : all_branches) {
-            if (branch.commit_id == commit.id) {
-                branches_on_commit.push_back(branch.name);
-            }
-        }
-        
-        // Draw commit info with appropriate color
-        if (is_head) {
-            wattron(pad, COLOR_PAIR(COLOR_HIGHLIGHT));
-        } else {
-            wattron(pad, COLOR_PAIR(COLOR_COMMIT));
-        }
-        
-        // Display commit ID and message
-        mvwprintw(pad, pad_row, 0, "* %s - \"%s\"", 
-                 commit.id.c_str(), commit.message.c_str());
-        
-        // Display branches pointing to this commit
-        if (!branches_on_commit.empty()) {
-            std::string branch_str = " (";
-            if (is_head) {
-                branch_str += "HEAD -> ";
-            }
-            
-            for (size_t i = 0; i < branches_on_commit.size(); ++i) {
-                branch_str += branches_on_commit[i];
-                if (i < branches_on_commit.size() - 1) {
-                    branch_str += ", ";
-                }
-            }
-            branch_str += ")";
-            
-            mvwprintw(pad, pad_row, commit.id.length() + commit.message.length() + 6, "%s", 
-                     branch_str.c_str());
-        } else if (is_head) {
-            mvwprintw(pad, pad_row, commit.id.length() + commit.message.length() + 6, " (HEAD)");
-        }
-        
-        if (is_head) {
-            wattroff(pad, COLOR_PAIR(COLOR_HIGHLIGHT));
-        } else {
-            wattroff(pad, COLOR_PAIR(COLOR_COMMIT));
-        }
-        
-        // Display commit details
-        wattron(pad, COLOR_PAIR(COLOR_DEFAULT));
-        mvwprintw(pad, pad_row + 1, 4, "Author: %s", commit.author.c_str());
-        mvwprintw(pad, pad_row + 2, 4, "Date: %s", commit.timestamp.c_str());
-        
-        // Display parent commit IDs
-        if (!commit.parent_ids.empty()) {
-            std::string parents = "Parents: ";
-            for (size_t i = 0; i < commit.parent_ids.size(); ++i) {
-                parents += commit.parent_ids[i];
-                if (i < commit.parent_ids.size() - 1) {
-                    parents += ", ";
-                }
-            }
-            mvwprintw(pad, pad_row + 3, 4, "%s", parents.c_str());
-        }
-        
-        // Draw connection line to parent
-        if (pad_row + 4 < static_cast<int>(commits.size() * 4)) {
-            mvwprintw(pad, pad_row + 3, 0, " |");
-        }
-        
-        wattroff(pad, COLOR_PAIR(COLOR_DEFAULT));
-        
-        pad_row += 4;
+    if (!range.empty()) {
+        mvprintw(3, 2, "Commits in %s (newest first):", range.c_str());
+    } else if (pathspec.empty()) {
+        mvprintw(3, 2, "Commit history (newest first):");
+    } else {
+        mvprintw(3, 2, "Commit history for %s (newest first):", pathspec.c_str());
     }
+    mvprintw(4, 2, "Use UP/DOWN arrows or PGUP/PGDN to scroll, 'q' to quit");
+    attroff(COLOR_PAIR(COLOR_DEFAULT));
     
     // Display success message and quip
     attron(COLOR_PAIR(COLOR_SUCCESS));
     mvprintw(LINES - 2, 2, "[gg] Showing commit history.");
     attroff(COLOR_PAIR(COLOR_SUCCESS));
-    
-    // Display a random quip
     mvprintw(LINES - 1, 2, "%s", QuipGenerator::get_random_quip(QuipGenerator::log_quips).c_str());
+    refresh();
     
-    // Display scrolling instructions
-    attron(COLOR_PAIR(COLOR_DEFAULT));
-    mvprintw(max_row, 2, "Use UP/DOWN arrows to scroll, 'q' to quit");
-    attroff(COLOR_PAIR(COLOR_DEFAULT));
+    // Window over the history: only the entries in view are drawn, and
+    // the walk is advanced just far enough to fill it
+    const int ENTRY_ROWS = 4;
+    WINDOW* log_win = newwin(LINES - 8, COLS - 4, 5, 2);
+    int view_rows = LINES - 10;
+    std::vector<CommitIndex> loaded;
+    bool exhausted = false;
+    auto fetch_until = [&](size_t entries) {
+        while (!exhausted && loaded.size() < entries) {
+            CommitIndex index = next_commit();
+            if (index == NO_COMMIT) {
+                exhausted = true;
+            } else {
+                loaded.push_back(index);
+            }
+        }
+    };
     
-    // Set up box for pad area
-    attron(COLOR_PAIR(COLOR_DEFAULT));
-    mvhline(max_row + 1, max_col, ACS_HLINE, win_width);
-    mvhline(LINES - 3, max_col, ACS_HLINE, win_width);
-    mvvline(max_row + 1, max_col, ACS_VLINE, LINES - max_row - 3);
-    mvvline(max_row + 1, max_col + win_width - 1, ACS_VLINE, LINES - max_row - 3);
-    mvaddch(max_row + 1, max_col, ACS_ULCORNER);
-    mvaddch(max_row + 1, max_col + win_width - 1, ACS_URCORNER);
-    mvaddch(LINES - 3, max_col, ACS_LLCORNER);
-    mvaddch(LINES - 3, max_col + win_width - 1, ACS_LRCORNER);
-    attroff(COLOR_PAIR(COLOR_DEFAULT));
+    int scroll = 0; // First visible row of the whole history
+    auto render = [&]() {
+        size_t first = static_cast<size_t>(scroll / ENTRY_ROWS);
+        fetch_until(first + static_cast<size_t>(view_rows / ENTRY_ROWS) + 2);
+        
+        werase(log_win);
+        box(log_win, 0, 0);
+        mvwprintw(log_win, 0, 2, " Commit History (%zu%s loaded) ", loaded.size(), exhausted ? "" : "+");
+        for (size_t entry = first; entry < loaded.size(); ++entry) {
+            int row = 1 + static_cast<int>(entry) * ENTRY_ROWS - scroll;
+            if (row > view_rows) {
+                break;
+            }
+            bool has_more = entry + 1 < loaded.size() || !exhausted;
+            draw_log_entry(log_win, row, repo, graph.commit_at(loaded[entry]), has_more);
+        }
+        wrefresh(log_win);
+    };
     
-    // Set up for pad scrolling
-    int pad_pos = 0;
-    int pad_height = LINES - max_row - 4;
-    int pad_max = pad_row > pad_height ? pad_row - pad_height : 0;
+    // Furthest scroll position once the rows up to target are loaded
+    auto max_scroll = [&](int target) {
+        fetch_until(static_cast<size_t>((target + view_rows) / ENTRY_ROWS) + 1);
+        return std::max(0, static_cast<int>(loaded.size()) * ENTRY_ROWS - view_rows);
+    };
     
-    // Display the pad
-    prefresh(pad, pad_pos, 0, max_row + 2, max_col + 1, LINES - 4, max_col + win_width - 2);
+    render();
     
     // Handle scrolling
     int ch;
@@ -199,35 +274,134 @@ void show_log() {
     
     while (!quit) {
         ch = getch();
+        int target = scroll;
         
         switch (ch) {
             case KEY_UP:
-                if (pad_pos > 0) {
-                    pad_pos--;
-                    prefresh(pad, pad_pos, 0, max_row + 2, max_col + 1, LINES - 4, max_col + win_width - 2);
-                }
+                target = scroll - 1;
                 break;
-                
+            
             case KEY_DOWN:
-                if (pad_pos < pad_max) {
-                    pad_pos++;
-                    prefresh(pad, pad_pos, 0, max_row + 2, max_col + 1, LINES - 4, max_col + win_width - 2);
-                }
+                target = scroll + 1;
+                break;
+            
+            case KEY_PPAGE:
+                target = scroll - view_rows;
+                break;
+            
+            case KEY_NPAGE:
+                target = scroll + view_rows;
                 break;
-                
+            
             case 'q':
             case 'Q':
                 quit = true;
                 break;
         }
+        
+        target = std::max(0, std::min(target, max_scroll(target)));
+        if (!quit && target != scroll) {
+            scroll = target;
+            render();
+        }
     }
     
     // Clean up UI
-    delwin(pad);
-    delwin(dag_win);
+    delwin(log_win);
     cleanup_ui();
 }
 
+// Show where HEAD or a branch has pointed, newest first, or only where it
+// pointed at a given time ("YYYY-MM-DD [HH:MM:SS]"; a date means its end)
+bool show_reflog(const std::string& ref, const std::string& at) {
+    // Check if we're in a gg repository
+    if (!fs::exists(".gg")) {
+        std::cerr << "Error: Not a gg repository (or any of the parent directories)" << std::endl;
+        return false;
+    }
+    
+    // Deleted branches keep their log, so it is looked up by name alone
+    Reflog reflog = ref == "HEAD" ? Reflog::for_head() : Reflog::for_branch(ref);
+    size_t count = reflog.size();
+    if (count == 0) {
+        std::cerr << "Error: No reflog for '" << ref << "'" << std::endl;
+        return false;
+    }
+    
+    // "<ref>@{n}" counts back from the newest entry, which is @{0}
+    auto describe = [&](const ReflogEntry& entry, size_t index) {
+        return entry.new_id + " " + ref + "@{" + std::to_string(count - 1 - index) + "} " +
+               format_timestamp(entry.time) + " " + entry.reason;
+    };
+    
+    std::vector<std::string> lines;
+    if (!at.empty()) {
+        int64_t time = parse_timestamp(at.size() == 10 ? at + " 23:59:59" : at);
+        if (time == 0) {
+            std::cerr << "Error: Invalid time '" << at << "' (use YYYY-MM-DD [HH:MM:SS])" << std::endl;
+            return false;
+        }
+        size_t index = reflog.find_at(time);
+        if (index == Reflog::NO_ENTRY) {
+            std::cerr << "Error: '" << ref << "' has no reflog entries at or before " << at << std::endl;
+            return false;
+        }
+        lines.push_back(describe(reflog.read(index, index + 1)[0], index));
+    } else {
+        std::vector<ReflogEntry> entries = reflog.read(0, count);
+        for (size_t i = entries.size(); i-- > 0;) {
+            lines.push_back(describe(entries[i], i));
+        }
+    }
+    
+    // Headless mode: one entry per line
+    if (is_headless_mode()) {
+        for (const auto& line : lines) {
+            std::cout << line << "\n";
+        }
+        std::cout.flush();
+        return true;
+    }
+    
+    // Initialize UI
+    init_ui();
+    clear();
+    
+    // Display header
+    display_header("Reflog");
+    
+    attron(COLOR_PAIR(COLOR_BRANCH));
+    if (at.empty()) {
+        mvprintw(2, 2, "Movements of %s (newest first):", ref.c_str());
+    } else {
+        mvprintw(2, 2, "Where %s pointed at %s:", ref.c_str(), at.c_str());
+    }
+    attroff(COLOR_PAIR(COLOR_BRANCH));
+    
+    attron(COLOR_PAIR(COLOR_COMMIT));
+    int row = 4;
+    for (const auto& line : lines) {
+        if (row >= LINES - 3) {
+            break;
+        }
+        mvprintw(row++, 4, "%s", line.c_str());
+    }
+    attroff(COLOR_PAIR(COLOR_COMMIT));
+    
+    // Display success message
+    attron(COLOR_PAIR(COLOR_SUCCESS));
+    mvprintw(LINES - 2, 2, "[gg] %zu of %zu reflog entries shown", lines.size(), count);
+    attroff(COLOR_PAIR(COLOR_SUCCESS));
+    
+    // Refresh and wait for user input
+    refresh();
+    getch();
+    
+    // Clean up UI
+    cleanup_ui();
+    return true;
+}
+
 // Command handler for 'gg log'
 bool log_command(int argc, char* argv[]) {
     show_log();
@@ -1,27 +1,54 @@
 #include "../include/gg.h"
+#include "../include/monitor.h"
 #include <iostream>
 #include <string>
 #include <vector>
+#include <cstring>
+#include <unistd.h>
 
 int main(int argc, char* argv[]) {
-    // Simple command-line interface without ncurses
-    std::cout << "gg - Git Learning CLI Tool" << std::endl;
-    std::cout << "===========================" << std::endl;
-    std::cout << std::endl;
+    // Global flags come before the command
+    bool batch = false;
+    while (argc > 1 && (strcmp(argv[1], "--batch") == 0 || strcmp(argv[1], "-b") == 0)) {
+        batch = true;
+        argv++;
+        argc--;
+    }
+    
+    // Run headless when asked to, or when stdout is not a terminal
+    set_headless_mode(batch || !isatty(STDOUT_FILENO));
 
     if (argc < 2) {
-        std::cout << "Usage: gg <command> [options]" << std::endl;
+        std::cout << "gg - Git Learning CLI Tool" << std::endl;
+        std::cout << "===========================" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Usage: gg [--batch] <command> [options]" << std::endl;
         std::cout << std::endl;
         std::cout << "Commands:" << std::endl;
         std::cout << "  bruh                    Initialize a new repository" << std::endl;
         std::cout << "  add <file>              Stage a file" << std::endl;
+        std::cout << "  rm [--cached] <file>    Stop tracking a file" << std::endl;
         std::cout << "  kermit -m \"message\"     Commit changes" << std::endl;
         std::cout << "  status                  Show repository status" << std::endl;
-        std::cout << "  log                     Show commit history" << std::endl;
+        std::cout << "  log [<base>..<tip>] [-- <path>]" << std::endl;
+        std::cout << "                          Show commit history (of a range, of a path)" << std::endl;
+        std::cout << "  reflog [<ref>] [--at <time>]" << std::endl;
+        std::cout << "                          Show where HEAD or a branch has pointed" << std::endl;
         std::cout << "  branch [name]           Create or list branches" << std::endl;
+        std::cout << "  branch --contains <id>  List branches containing a commit" << std::endl;
+        std::cout << "  branch --list <pattern> List branches matching a prefix or glob" << std::endl;
+        std::cout << "  branch --sort=[-]committerdate [--count=<n>]" << std::endl;
+        std::cout << "                          List branches by latest commit time" << std::endl;
+        std::cout << "  pack-refs               Fold loose branch refs into one file" << std::endl;
+        std::cout << "  checkout <branch>       Switch to a branch" << std::endl;
         std::cout << "  merge <branch>          Merge a branch" << std::endl;
+        std::cout << "  monitor [start|stop]    Watch the worktree to speed up status" << std::endl;
         std::cout << "  learn <topic>           Learn about a topic" << std::endl;
         std::cout << std::endl;
+        std::cout << "Options:" << std::endl;
+        std::cout << "  -b, --batch             Skip the ncurses UI and print plain text" << std::endl;
+        std::cout << "                          (default when stdout is not a terminal)" << std::endl;
+        std::cout << std::endl;
         std::cout << "For more information, see the README.md file." << std::endl;
         return 0;
     }
@@ -29,16 +56,22 @@ int main(int argc, char* argv[]) {
     std::string command = argv[1];
 
     if (command == "bruh") {
-        std::cout << "Initializing a new repository..." << std::endl;
-        std::cout << "This feature is not available in the simplified version." << std::endl;
+        return init_repository() ? 0 : 1;
     } else if (command == "add") {
         if (argc < 3) {
             std::cout << "Error: No file specified" << std::endl;
             std::cout << "Usage: gg add <file>" << std::endl;
             return 1;
         }
-        std::cout << "Staging file: " << argv[2] << std::endl;
-        std::cout << "This feature is not available in the simplified version." << std::endl;
+        return add_file(argv[2]) ? 0 : 1;
+    } else if (command == "rm") {
+        bool keep_file = argc > 2 && std::string(argv[2]) == "--cached";
+        if (argc < (keep_file ? 4 : 3)) {
+            std::cout << "Error: No file specified" << std::endl;
+            std::cout << "Usage: gg rm [--cached] <file>" << std::endl;
+            return 1;
+        }
+        return remove_file(argv[keep_file ? 3 : 2], keep_file) ? 0 : 1;
     } else if (command == "kermit" || command == "commit") {
         if (argc < 3 || std::string(argv[2]) != "-m") {
             std::cout << "Error: Missing commit message" << std::endl;
@@ -52,29 +85,93 @@ int main(int argc, char* argv[]) {
             std::cout << "   or: gg commit -m \"<message>\"" << std::endl;
             return 1;
         }
-        std::cout << "Committing changes with message: " << argv[3] << std::endl;
-        std::cout << "This feature is not available in the simplified version." << std::endl;
+        return commit_changes(argv[3]) ? 0 : 1;
     } else if (command == "status") {
-        std::cout << "Showing repository status..." << std::endl;
-        std::cout << "This feature is not available in the simplified version." << std::endl;
+        show_status();
     } else if (command == "log") {
-        std::cout << "Showing commit history..." << std::endl;
-        std::cout << "This feature is not available in the simplified version." << std::endl;
+        // gg log [<base>..<tip>] [--] [<path>]
+        int arg = 2;
+        std::string range;
+        if (arg < argc && std::string(argv[arg]) != "--" &&
+            std::string(argv[arg]).find("..") != std::string::npos) {
+            range = argv[arg++];
+        }
+        if (arg < argc && std::string(argv[arg]) == "--") {
+            arg++;
+        }
+        show_log(arg < argc ? argv[arg] : "", range);
+    } else if (command == "reflog") {
+        // gg reflog [<ref>] [--at <time>]
+        int arg = 2;
+        std::string ref = (arg < argc && std::string(argv[arg]) != "--at") ? argv[arg++] : "HEAD";
+        std::string at;
+        if (arg < argc) {
+            if (std::string(argv[arg]) != "--at" || arg + 2 != argc) {
+                std::cout << "Usage: gg reflog [<ref>] [--at <time>]" << std::endl;
+                return 1;
+            }
+            at = argv[arg + 1];
+        }
+        return show_reflog(ref, at) ? 0 : 1;
     } else if (command == "branch") {
         if (argc < 3) {
-            std::cout << "Listing branches..." << std::endl;
+            list_branches();
+        } else if (std::string(argv[2]) == "--contains") {
+            if (argc < 4) {
+                std::cout << "Usage: gg branch --contains <commit>" << std::endl;
+                return 1;
+            }
+            list_branches(argv[3]);
+        } else if (std::string(argv[2]) == "--list") {
+            if (argc < 4) {
+                std::cout << "Usage: gg branch --list <prefix-or-glob>" << std::endl;
+                return 1;
+            }
+            list_matching_branches(argv[3]);
+        } else if (std::string(argv[2]).compare(0, 7, "--sort=") == 0) {
+            // gg branch --sort=<key> [--count=<n>]
+            size_t count = 0;
+            if (argc > 3 && !parse_branch_count(argv[3], count)) {
+                std::cout << "Usage: gg branch --sort=[-]committerdate [--count=<n>]" << std::endl;
+                return 1;
+            }
+            return list_sorted_branches(std::string(argv[2]).substr(7), count) ? 0 : 1;
         } else {
-            std::cout << "Creating branch: " << argv[2] << std::endl;
+            return create_branch(argv[2]) ? 0 : 1;
+        }
+    } else if (command == "pack-refs") {
+        return pack_refs() ? 0 : 1;
+    } else if (command == "checkout" || command == "switch") {
+        if (argc < 3) {
+            std::cout << "Error: No branch specified" << std::endl;
+            std::cout << "Usage: gg checkout <branch-name>" << std::endl;
+            return 1;
         }
-        std::cout << "This feature is not available in the simplified version." << std::endl;
+        return switch_branch(argv[2]) ? 0 : 1;
     } else if (command == "merge") {
         if (argc < 3) {
             std::cout << "Error: No branch specified" << std::endl;
             std::cout << "Usage: gg merge <branch-name>" << std::endl;
             return 1;
         }
-        std::cout << "Merging branch: " << argv[2] << std::endl;
-        std::cout << "This feature is not available in the simplified version." << std::endl;
+        return merge_branch(argv[2]) ? 0 : 1;
+    } else if (command == "monitor") {
+        std::string action = argc < 3 ? "status" : argv[2];
+        if (action == "start") {
+            return start_monitor() ? 0 : 1;
+        } else if (action == "stop") {
+            if (!stop_monitor()) {
+                std::cout << "[gg] Monitor is not running." << std::endl;
+                return 1;
+            }
+            std::cout << "[gg] Monitor stopped." << std::endl;
+        } else if (action == "status") {
+            std::cout << "[gg] Monitor is " << (monitor_is_running() ? "running." : "not running.") << std::endl;
+        } else {
+            std::cout << "Error: Unknown monitor action '" << action << "'" << std::endl;
+            std::cout << "Usage: gg monitor [start|stop|status]" << std::endl;
+            return 1;
+        }
     } else if (command == "learn") {
         if (argc < 3) {
             std::cout << "Error: No topic specified" << std::endl;
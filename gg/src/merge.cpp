@@ -11,11 +11,15 @@
 #include "../include/avl.h"
 #include "../include/trie.h"
 #include "../include/skiplist.h"
+#include "../include/objects.h"
+#include "../include/pathindex.h"
+#include "../include/generation.h"
 #include <iostream>
 #include <filesystem>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <map>
 #include <ncurses.h>
 
 namespace fs = std::filesystem;
@@ -32,11 +36,33 @@ const std::vector<std::string> QuipGenerator::merge_quips = {
     "Merge complete. Remember when you thought version control was boring?"
 };
 
-// Simulate finding potential conflicts between branches
+// Blob a path had at a commit: the nearest snapshot along first parents
+static std::string version_at(const DAG& graph, CommitIndex index, const std::string& path) {
+    while (index != NO_COMMIT) {
+        const Commit& commit = graph.commit_at(index);
+        auto it = commit.file_snapshots.find(path);
+        if (it != commit.file_snapshots.end()) {
+            return it->second;
+        }
+        CommitRange parents = graph.parents(index);
+        index = parents.empty() ? NO_COMMIT : *parents.begin();
+    }
+    return "";
+}
+
+// First line of a blob, for the one-line conflict display
+static std::string describe_blob(const ObjectStore& store, const std::string& blob_id) {
+    ObjectType type;
+    std::string data;
+    if (blob_id.empty() || !store.read_object(blob_id, type, data)) {
+        return "(not present)";
+    }
+    return data.substr(0, data.find('\n'));
+}
+
+// Files changed differently on both branches since their merge base
 std::vector<DisjointSet::MergeConflict> find_conflicts(const GGRepo& repo, 
                                                       const std::string& source_branch) {
-    // This is a simplified simulation of conflict detection
-    // In a real implementation, we would compare file snapshots
     std::vector<DisjointSet::MergeConflict> conflicts;
     
     // Get branch info
@@ -48,38 +74,96 @@ std::vector<DisjointSet::MergeConflict> find_conflicts(const GGRepo& repo,
     }
     
     // Get commits for branches
-    std::shared_ptr<DAGNode> source_commit = repo.commit_graph->get_commit(source->commit_id);
-    std::shared_ptr<DAGNode> target_commit = repo.commit_graph->get_commit(target->commit_id);
+    const DAG& graph = *repo.commit_graph;
+    CommitIndex source_commit = graph.find(source->commit_id);
+    CommitIndex target_commit = graph.find(target->commit_id);
     
-    if (!source_commit || !target_commit) {
+    if (source_commit == NO_COMMIT || target_commit == NO_COMMIT) {
         return conflicts;
     }
     
-    // Find common ancestor (in a real implementation, we'd traverse the DAG)
-    // Here we'll just pretend the initial commit is the common ancestor
-    std::vector<std::shared_ptr<DAGNode>> all_commits = repo.commit_graph->breadth_first_search();
-    std::shared_ptr<DAGNode> common_ancestor = all_commits.empty() ? nullptr : all_commits.back();
-    
-    // Get all files in both branches
-    std::vector<std::pair<std::string, FileStatus>> all_files = repo.file_trie->get_all_files();
-    
-    // For demo purposes, create a simulated conflict on every 3rd file
-    for (size_t i = 0; i < all_files.size(); ++i) {
-        if (i % 3 == 0 && all_files[i].second == FileStatus::COMMITTED) {
-            DisjointSet::MergeConflict conflict;
-            conflict.file_path = all_files[i].first;
-            conflict.base_content = "Base content"; // Would be from common ancestor
-            conflict.ours_content = "Our changes"; // Would be from target branch
-            conflict.theirs_content = "Their changes"; // Would be from source branch
-            conflict.resolved = false;
-            
-            conflicts.push_back(conflict);
+    // Walk both tips down to their merge base, collecting the commits
+    // each side has that the other lacks
+    MergeBaseWalk walk = repo.generations->walk(graph, target_commit, source_commit);
+    CommitIndex common_ancestor = walk.bases.empty() ? NO_COMMIT : walk.bases.front();
+    
+    // Latest version of each path changed on a side; the walk yields
+    // newer commits first, so the first snapshot seen wins
+    auto side_changes = [&graph](const std::vector<CommitIndex>& side) {
+        std::map<std::string, std::string> changes;
+        for (CommitIndex index : side) {
+            for (const auto& [path, blob_id] : graph.commit_at(index).file_snapshots) {
+                changes.emplace(path, blob_id);
+            }
         }
+        return changes;
+    };
+    std::map<std::string, std::string> ours = side_changes(walk.only_ours);
+    std::map<std::string, std::string> theirs = side_changes(walk.only_theirs);
+    
+    ObjectStore store;
+    for (const auto& [path, ours_blob] : ours) {
+        auto it = theirs.find(path);
+        if (it == theirs.end() || it->second == ours_blob) {
+            continue;
+        }
+        
+        DisjointSet::MergeConflict conflict;
+        conflict.file_path = path;
+        conflict.base_content = describe_blob(store, version_at(graph, common_ancestor, path));
+        conflict.ours_content = describe_blob(store, ours_blob);
+        conflict.theirs_content = describe_blob(store, it->second);
+        conflict.resolved = false;
+        
+        conflicts.push_back(conflict);
     }
     
     return conflicts;
 }
 
+// Record conflict resolutions in the disjoint set and create the merge
+// commit, advancing HEAD and the current branch to it
+static Commit record_merge(GGRepo& repo, const std::string& source_branch,
+                           const BranchInfo& source,
+                           const std::vector<DisjointSet::MergeConflict>& conflicts) {
+    // Update disjoint set to resolve conflicts
+    for (const auto& conflict : conflicts) {
+        // Create sets for each file involved
+        repo.merge_sets->make_set(conflict.file_path + "_ours");
+        repo.merge_sets->make_set(conflict.file_path + "_theirs");
+        
+        // Union them to mark as resolved
+        repo.merge_sets->union_sets(conflict.file_path + "_ours", conflict.file_path + "_theirs");
+    }
+    
+    // Create a new merge commit
+    Commit merge_commit;
+    merge_commit.message = "Merge branch '" + source_branch + "' into " + repo.current_branch;
+    merge_commit.author = "gg";
+    merge_commit.timestamp = get_current_time_string();
+    merge_commit.parent_ids.push_back(repo.head_commit);
+    merge_commit.parent_ids.push_back(source.commit_id);
+    merge_commit.id = ObjectStore().write_commit(merge_commit);
+    
+    // Update the graph, with the merge's changed-path filter alongside
+    repo.commit_graph->add_commit(merge_commit, {repo.head_commit, source.commit_id});
+    ChangedPathIndex::append(merge_commit);
+    
+    // Update HEAD and branch
+    repo.head_commit = merge_commit.id;
+    repo.branches->update_commit(repo.current_branch, merge_commit.id, merge_commit.timestamp);
+    
+    // Record the move in the branch's and HEAD's reflogs
+    std::string reason = "merge " + source_branch + ": Merge made";
+    repo.log_branch_move(repo.current_branch, merge_commit.parent_ids[0], merge_commit.id, reason);
+    repo.log_head_move(merge_commit.parent_ids[0], merge_commit.id, reason);
+    
+    // Update skip list
+    repo.commit_list->insert(merge_commit.id, merge_commit.timestamp);
+    
+    return merge_commit;
+}
+
 // Merge one branch into the current branch
 bool merge_branch(const std::string& source_branch) {
     // Check if we're in a gg repository
@@ -107,6 +191,21 @@ bool merge_branch(const std::string& source_branch) {
     // Find potential merge conflicts
     std::vector<DisjointSet::MergeConflict> conflicts = find_conflicts(repo, source_branch);
     
+    // Headless mode: auto-resolve, commit and report in plain text
+    if (is_headless_mode()) {
+        for (const auto& conflict : conflicts) {
+            std::cout << "Conflict in file: " << conflict.file_path << " (auto-resolved)" << std::endl;
+        }
+        Commit merge_commit = record_merge(repo, source_branch, *source, conflicts);
+        if (!repo.save()) {
+            return false;
+        }
+        std::cout << "[gg] Merged branch '" << source_branch << "' into '" 
+                  << repo.current_branch << "'" << std::endl;
+        std::cout << "Merge commit: " << merge_commit.id << std::endl;
+        return true;
+    }
+    
     // Initialize UI
     init_ui();
     clear();
@@ -176,40 +275,14 @@ bool merge_branch(const std::string& source_branch) {
         napms(1000); // Wait to show resolution
         
         delwin(conflict_win);
-        
-        // Update disjoint set to resolve conflicts
-        for (const auto& conflict : conflicts) {
-            // Create sets for each file involved
-            repo.merge_sets->make_set(conflict.file_path + "_ours");
-            repo.merge_sets->make_set(conflict.file_path + "_theirs");
-            
-            // Union them to mark as resolved
-            repo.merge_sets->union_sets(conflict.file_path + "_ours", conflict.file_path + "_theirs");
-        }
     } else {
         attron(COLOR_PAIR(COLOR_SUCCESS));
         mvprintw(4, 55, "No conflicts detected!");
         attroff(COLOR_PAIR(COLOR_SUCCESS));
     }
     
-    // Create a new merge commit
-    Commit merge_commit;
-    merge_commit.id = generate_commit_id();
-    merge_commit.message = "Merge branch '" + source_branch + "' into " + repo.current_branch;
-    merge_commit.author = "gg";
-    merge_commit.timestamp = get_current_time_string();
-    merge_commit.parent_ids.push_back(repo.head_commit);
-    merge_commit.parent_ids.push_back(source->commit_id);
-    
-    // Update the graph
-    repo.commit_graph->add_commit(merge_commit, {repo.head_commit, source->commit_id});
-    
-    // Update HEAD and branch
-    repo.head_commit = merge_commit.id;
-    repo.branches->update_commit(repo.current_branch, merge_commit.id, merge_commit.timestamp);
-    
-    // Update skip list
-    repo.commit_list->insert(merge_commit.id, merge_commit.timestamp);
+    // Resolve conflicts and create the merge commit
+    Commit merge_commit = record_merge(repo, source_branch, *source, conflicts);
     
     // Draw updated DAG
     WINDOW* dag_after_win = newwin(10, 50, 4, 55);
@@ -226,7 +299,10 @@ bool merge_branch(const std::string& source_branch) {
     wrefresh(disjoint_after_win);
     
     // Save repository state
-    repo.save();
+    if (!repo.save()) {
+        cleanup_ui();
+        return false;
+    }
     
     // Display success message and quip
     attron(COLOR_PAIR(COLOR_SUCCESS));
@@ -0,0 +1,455 @@
+/**
+ * monitor.cpp - Filesystem monitor and change journal
+ *
+ * The monitor keeps one inotify watch per worktree directory (excluding
+ * .gg/) and turns each event into a journal record. New directories are
+ * watched and scanned as they appear, since files created in them before
+ * the watch existed would otherwise be missed. Anything the monitor cannot
+ * track precisely (event queue overflow, directories moved around) resets
+ * the journal, which makes the next status do a full scan. Status cookies
+ * created in .gg/monitor/ are journaled too, marking how far it has read.
+ */
+
+#include "../include/monitor.h"
+#include "../include/serial.h"
+#include "../include/ignore.h"
+#include "../include/gg.h"
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// ChangeJournal implementation
+ChangeJournal::ChangeJournal() : epoch(0), latest(0) {
+}
+
+bool ChangeJournal::load(const std::string& filepath) {
+    std::string data = read_file_contents(filepath);
+    BinaryReader reader(data);
+    if (!reader.read_header("GGJR")) {
+        return false;
+    }
+
+    epoch = reader.read_u64();
+    latest = 0;
+    records.clear();
+
+    // The monitor may be mid-append; a truncated final record is ignored
+    while (reader.ok() && !reader.at_end()) {
+        uint64_t token = reader.read_u64();
+        std::string path = reader.read_string();
+        if (!reader.ok()) {
+            break;
+        }
+        records.push_back({token, path});
+        latest = token;
+    }
+    return epoch != 0;
+}
+
+uint64_t ChangeJournal::get_epoch() const {
+    return epoch;
+}
+
+uint64_t ChangeJournal::get_latest_token() const {
+    return latest;
+}
+
+bool ChangeJournal::changes_since(uint64_t since_epoch, uint64_t since_token,
+                                  std::set<std::string>& paths) const {
+    if (epoch == 0 || since_epoch != epoch || since_token > latest) {
+        return false;
+    }
+
+    // Records are appended in token order, so skip straight past old ones
+    auto it = std::upper_bound(records.begin(), records.end(), since_token,
+        [](uint64_t token, const std::pair<uint64_t, std::string>& record) {
+            return token < record.first;
+        });
+    for (; it != records.end(); ++it) {
+        paths.insert(it->second);
+    }
+    return true;
+}
+
+bool sync_with_monitor(ChangeJournal& journal, int timeout_ms) {
+    journal.load();
+    uint64_t epoch = journal.get_epoch();
+    uint64_t token = journal.get_latest_token();
+
+    // Recreate the cookie so the monitor sees a fresh IN_CREATE for it
+    std::string cookie = std::string(MONITOR_DIR) + "/" + MONITOR_COOKIE_PREFIX +
+                         std::to_string(getpid());
+    unlink(cookie.c_str());
+    int fd = open(cookie.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    close(fd);
+
+    // Only a record after the starting position counts, since an earlier
+    // process with the same pid left one too. A reset journal (new epoch)
+    // makes status scan everything anyway, and may have dropped the cookie.
+    bool synced = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        std::set<std::string> changed;
+        if (journal.load() && (journal.get_epoch() != epoch ||
+                               (journal.changes_since(epoch, token, changed) && changed.count(cookie)))) {
+            synced = true;
+            break;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        usleep(1000);
+    }
+
+    unlink(cookie.c_str());
+    return synced;
+}
+
+// Monitor process control
+static pid_t read_monitor_pid() {
+    std::ifstream file(MONITOR_PID_FILE);
+    long pid = 0;
+    if (!(file >> pid)) {
+        return 0;
+    }
+    return static_cast<pid_t>(pid);
+}
+
+bool monitor_is_running() {
+    pid_t pid = read_monitor_pid();
+    return pid > 0 && kill(pid, 0) == 0;
+}
+
+bool stop_monitor() {
+    pid_t pid = read_monitor_pid();
+    if (pid <= 0 || kill(pid, SIGTERM) != 0) {
+        std::error_code ec;
+        fs::remove(MONITOR_PID_FILE, ec);
+        return false;
+    }
+    return true;
+}
+
+#ifdef __linux__
+
+static volatile sig_atomic_t monitor_stop_requested = 0;
+
+static void handle_stop_signal(int) {
+    monitor_stop_requested = 1;
+}
+
+// Watches and journal state of the running monitor
+class MonitorState {
+private:
+    int inotify_fd;
+    int cookie_wd;      // Watch on .gg/monitor for status cookies
+    int journal_fd;
+    uint64_t next_token;
+    size_t record_count;
+    std::map<int, std::string> watch_paths; // watch descriptor -> directory
+    BinaryWriter pending;
+    IgnoreMatcher ignore; // Ignored directories are not watched
+
+public:
+    MonitorState() : inotify_fd(-1), cookie_wd(-1), journal_fd(-1), next_token(1), record_count(0) {}
+
+    ~MonitorState() {
+        if (journal_fd >= 0) close(journal_fd);
+        if (inotify_fd >= 0) close(inotify_fd);
+    }
+
+    bool open_inotify() {
+        inotify_fd = inotify_init1(IN_CLOEXEC);
+        return inotify_fd >= 0;
+    }
+
+    int get_inotify_fd() const {
+        return inotify_fd;
+    }
+
+    // Start a fresh journal under a new epoch
+    void reset_journal() {
+        if (journal_fd >= 0) {
+            close(journal_fd);
+        }
+
+        uint64_t epoch = static_cast<uint64_t>(
+            std::chrono::system_clock::now().time_since_epoch().count());
+        BinaryWriter header;
+        header.write_header("GGJR");
+        header.write_u64(epoch);
+        write_file_contents(MONITOR_JOURNAL_FILE, header.data());
+
+        journal_fd = open(MONITOR_JOURNAL_FILE, O_WRONLY | O_APPEND | O_CLOEXEC);
+        next_token = 1;
+        record_count = 0;
+    }
+
+    // Remove the journal so status stops trusting it and scans instead
+    void invalidate_journal() {
+        if (journal_fd >= 0) {
+            close(journal_fd);
+            journal_fd = -1;
+        }
+        unlink(MONITOR_JOURNAL_FILE);
+    }
+
+    void record(const std::string& path) {
+        pending.write_u64(next_token++);
+        pending.write_string(path);
+        record_count++;
+    }
+
+    // Append all records from one batch of events with a single write
+    void flush() {
+        const std::string& data = pending.data();
+        if (!data.empty() && journal_fd >= 0) {
+            ssize_t written = write(journal_fd, data.data(), data.size());
+            (void)written;
+        }
+        pending = BinaryWriter();
+
+        if (record_count > ChangeJournal::MAX_RECORDS) {
+            reset_journal();
+        }
+    }
+
+    // Watch dir and everything below it; when journal_files is set, also
+    // record the files found (they may predate the watch)
+    void watch_tree(const std::string& dir, bool journal_files) {
+        uint32_t mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                        IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+        int wd = inotify_add_watch(inotify_fd, dir.c_str(), mask);
+        if (wd < 0) {
+            return;
+        }
+        watch_paths[wd] = dir;
+
+        DIR* handle = opendir(dir.c_str());
+        if (!handle) {
+            return;
+        }
+        std::vector<std::string> subdirs;
+        while (struct dirent* entry = readdir(handle)) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") {
+                continue;
+            }
+            std::string path = dir == "." ? name : dir + "/" + name;
+            struct stat st;
+            if (lstat(path.c_str(), &st) != 0) {
+                continue;
+            }
+            if (S_ISDIR(st.st_mode)) {
+                if (path != ".gg" && !ignore.matches(path, true)) {
+                    subdirs.push_back(path);
+                }
+            } else if (journal_files) {
+                record(path);
+            }
+        }
+        closedir(handle);
+
+        for (const auto& subdir : subdirs) {
+            watch_tree(subdir, journal_files);
+        }
+    }
+
+    // Drop every watch and start over, e.g. after directories moved
+    void rewatch_all() {
+        for (const auto& [wd, dir] : watch_paths) {
+            inotify_rm_watch(inotify_fd, wd);
+        }
+        watch_paths.clear();
+        pending = BinaryWriter();
+        reset_journal();
+        watch_all();
+    }
+
+    void watch_all() {
+        ignore.load();
+        watch_tree(".", false);
+    }
+
+    // Only creations are watched, so the monitor's own writes to the
+    // journal and the status cache next to it raise no events
+    void watch_cookies() {
+        cookie_wd = inotify_add_watch(inotify_fd, MONITOR_DIR, IN_CREATE | IN_ONLYDIR);
+    }
+
+    void handle_event(const struct inotify_event* event) {
+        if (event->mask & IN_Q_OVERFLOW) {
+            rewatch_all();
+            return;
+        }
+
+        if (event->wd == cookie_wd) {
+            std::string name = event->len > 0 ? event->name : "";
+            if (name.compare(0, std::strlen(MONITOR_COOKIE_PREFIX), MONITOR_COOKIE_PREFIX) == 0) {
+                record(std::string(MONITOR_DIR) + "/" + name);
+            }
+            return;
+        }
+
+        auto it = watch_paths.find(event->wd);
+        if (it == watch_paths.end()) {
+            return;
+        }
+        if (event->mask & IN_IGNORED) {
+            watch_paths.erase(it);
+            return;
+        }
+
+        std::string dir = it->second;
+        std::string path = event->len > 0
+            ? (dir == "." ? std::string(event->name) : dir + "/" + event->name)
+            : dir;
+
+        if (event->mask & IN_ISDIR) {
+            if (path == ".gg" || ignore.matches(path, true)) {
+                return;
+            }
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                watch_tree(path, true);
+            } else if (event->mask & IN_MOVED_FROM) {
+                // Watches below a moved directory now carry stale paths
+                rewatch_all();
+            }
+            return;
+        }
+        if (event->mask & IN_MOVE_SELF || path == GGIGNORE_FILE) {
+            // A changed .ggignore can bring ignored directories back
+            rewatch_all();
+            return;
+        }
+
+        record(path);
+    }
+};
+
+void run_monitor() {
+    MonitorState state;
+    if (!state.open_inotify()) {
+        std::cerr << "Error: inotify is not available" << std::endl;
+        return;
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = handle_stop_signal;
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGINT, &action, nullptr);
+
+    std::error_code ec;
+    fs::create_directories(MONITOR_DIR, ec);
+    state.reset_journal();
+    state.watch_cookies();
+    state.watch_all();
+
+    // Publish the pid only once every directory is watched, so a status run
+    // that sees a live monitor can trust the journal to be complete
+    write_file_contents(MONITOR_PID_FILE, std::to_string(getpid()) + "\n");
+
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    while (!monitor_stop_requested) {
+        ssize_t length = read(state.get_inotify_fd(), buffer, sizeof(buffer));
+        if (length < 0 && errno == EINTR) {
+            continue; // Interrupted by a signal
+        }
+        if (length <= 0) {
+            // Events can no longer be seen, so the journal would go stale
+            std::cerr << "Error: Could not read filesystem events: "
+                      << (length < 0 ? std::strerror(errno) : "no data") << std::endl;
+            state.invalidate_journal();
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < length; ) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            state.handle_event(event);
+            offset += sizeof(struct inotify_event) + event->len;
+        }
+        state.flush();
+    }
+
+    fs::remove(MONITOR_PID_FILE, ec);
+}
+
+bool start_monitor() {
+    if (!fs::exists(".gg")) {
+        std::cerr << "Error: Not a gg repository (or any of the parent directories)" << std::endl;
+        return false;
+    }
+    if (monitor_is_running()) {
+        std::cerr << "Error: Monitor is already running" << std::endl;
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(MONITOR_DIR, ec);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "Error: Could not start monitor" << std::endl;
+        return false;
+    }
+
+    if (pid == 0) {
+        // Detach from the terminal and run until stopped; errors go to the log
+        setsid();
+        int null_fd = open("/dev/null", O_RDWR);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDIN_FILENO);
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            close(null_fd);
+        }
+        int log_fd = open(MONITOR_LOG_FILE, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (log_fd >= 0) {
+            dup2(log_fd, STDERR_FILENO);
+            close(log_fd);
+        }
+        run_monitor();
+        _exit(0);
+    }
+
+    // Wait briefly for the monitor to finish adding its watches
+    for (int i = 0; i < 100 && !monitor_is_running(); ++i) {
+        usleep(10000);
+    }
+    std::cout << "[gg] Monitor started (pid " << pid << ")." << std::endl;
+    return true;
+}
+
+#else
+
+void run_monitor() {
+    std::cerr << "Error: The filesystem monitor requires inotify (Linux)" << std::endl;
+}
+
+bool start_monitor() {
+    run_monitor();
+    return false;
+}
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * objects.cpp - Content-addressed object store
+ *
+ * Every object is stored as "<type> <size>\0<data>" and named by the SHA-256
+ * of exactly those bytes, so the name is both the lookup key and a checksum.
+ */
+
+#include "../include/objects.h"
+#include "../include/hash.h"
+#include "../include/serial.h"
+#include "../include/dag.h"
+#include "../include/gg.h"
+#include <filesystem>
+#include <fstream>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static const char* type_name(ObjectType type) {
+    switch (type) {
+        case ObjectType::BLOB: return "blob";
+        case ObjectType::COMMIT: return "commit";
+    }
+    return "unknown";
+}
+
+static std::string object_header(ObjectType type, size_t size) {
+    std::string header = type_name(type);
+    header += ' ';
+    header += std::to_string(size);
+    header += '\0';
+    return header;
+}
+
+// ObjectStore implementation
+ObjectStore::ObjectStore(const std::string& root) : root(root) {
+}
+
+std::string ObjectStore::object_path(const std::string& id) const {
+    // Fan out by the first byte of the hash: objects/ab/cdef...
+    return root + "/" + id.substr(0, 2) + "/" + id.substr(2);
+}
+
+std::string ObjectStore::hash_object(ObjectType type, const std::string& data) {
+    Sha256 hasher;
+    hasher.update(object_header(type, data.size()));
+    hasher.update(data);
+    return hasher.finish_hex();
+}
+
+std::string ObjectStore::write_object(ObjectType type, const std::string& data) {
+    std::string id = hash_object(type, data);
+    std::string path = object_path(id);
+    
+    // Identical contents hash to the same name, so they are stored once
+    if (fs::exists(path)) {
+        return id;
+    }
+    
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    write_file_contents(path, object_header(type, data.size()) + data);
+    return id;
+}
+
+bool ObjectStore::read_object(const std::string& id, ObjectType& type, std::string& data) const {
+    if (id.size() < 3) {
+        return false;
+    }
+    
+    std::string raw = read_file_contents(object_path(id));
+    size_t space = raw.find(' ');
+    size_t nul = raw.find('\0');
+    if (space == std::string::npos || nul == std::string::npos || space > nul) {
+        return false;
+    }
+    
+    std::string name = raw.substr(0, space);
+    if (name == "blob") {
+        type = ObjectType::BLOB;
+    } else if (name == "commit") {
+        type = ObjectType::COMMIT;
+    } else {
+        return false;
+    }
+    
+    data = raw.substr(nul + 1);
+    return std::to_string(data.size()) == raw.substr(space + 1, nul - space - 1);
+}
+
+bool ObjectStore::has_object(const std::string& id) const {
+    return id.size() > 2 && fs::exists(object_path(id));
+}
+
+std::string ObjectStore::ingest_file(const std::string& filepath, bool store) {
+    std::error_code ec;
+    if (!fs::is_regular_file(filepath, ec)) {
+        return "";
+    }
+    uint64_t size = fs::file_size(filepath, ec);
+    if (ec) {
+        return "";
+    }
+    
+    std::ifstream in(filepath, std::ios::binary);
+    if (!in) {
+        return "";
+    }
+    
+    // When storing, hash and copy to a temporary object in one pass; the
+    // final name is only known once the last chunk has been hashed. The temp
+    // name is unique so concurrent gg add processes never share a file.
+    std::string temp_path;
+    std::ofstream out;
+    if (store) {
+        fs::create_directories(root, ec);
+        std::string pattern = root + "/incoming-XXXXXX";
+        int fd = mkstemp(pattern.data());
+        if (fd < 0) {
+            return "";
+        }
+        close(fd);
+        temp_path = pattern;
+        out.open(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            fs::remove(temp_path, ec);
+            return "";
+        }
+    }
+    
+    std::string header = object_header(ObjectType::BLOB, size);
+    Sha256 hasher;
+    hasher.update(header);
+    if (store) {
+        out.write(header.data(), header.size());
+    }
+    
+    buffer.resize(CHUNK_SIZE);
+    uint64_t copied = 0;
+    while (in) {
+        in.read(buffer.data(), buffer.size());
+        std::streamsize got = in.gcount();
+        if (got <= 0) {
+            break;
+        }
+        hasher.update(buffer.data(), static_cast<size_t>(got));
+        if (store) {
+            out.write(buffer.data(), got);
+        }
+        copied += static_cast<uint64_t>(got);
+    }
+    
+    // The file changed size while we were reading it
+    if (store) {
+        out.close();
+        if (copied != size || !out) {
+            fs::remove(temp_path, ec);
+            return "";
+        }
+    } else if (copied != size) {
+        return "";
+    }
+    
+    std::string id = hasher.finish_hex();
+    if (!store) {
+        return id;
+    }
+    
+    std::string path = object_path(id);
+    if (fs::exists(path)) {
+        fs::remove(temp_path, ec);
+        return id;
+    }
+    
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    fs::rename(temp_path, path, ec);
+    return ec ? "" : id;
+}
+
+std::string ObjectStore::write_blob_from_file(const std::string& filepath) {
+    return ingest_file(filepath, true);
+}
+
+std::string ObjectStore::hash_blob_from_file(const std::string& filepath) {
+    return ingest_file(filepath, false);
+}
+
+std::string ObjectStore::encode_commit(const Commit& commit) {
+    // The ID is not part of the encoding: it is the hash of the encoding
+    BinaryWriter writer;
+    writer.write_u32(static_cast<uint32_t>(commit.parent_ids.size()));
+    for (const auto& parent_id : commit.parent_ids) {
+        writer.write_string(parent_id);
+    }
+    writer.write_string(commit.author);
+    writer.write_string(commit.timestamp);
+    writer.write_string(commit.message);
+    writer.write_u32(static_cast<uint32_t>(commit.file_snapshots.size()));
+    for (const auto& [file, hash] : commit.file_snapshots) {
+        writer.write_string(file);
+        writer.write_string(hash);
+    }
+    return writer.data();
+}
+
+std::string ObjectStore::write_commit(const Commit& commit) {
+    return write_object(ObjectType::COMMIT, encode_commit(commit));
+}
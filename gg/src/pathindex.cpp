@@ -0,0 +1,110 @@
+/**
+ * pathindex.cpp - Changed-path Bloom filters for path-limited history
+ *
+ * The file is a header followed by one record per commit: the commit id, a
+ * flag for commits with too many changed paths to be worth a filter, and
+ * the filter itself. Records are only ever appended, so creating a commit
+ * never rewrites the filters of the ones before it.
+ */
+
+#include "../include/pathindex.h"
+#include "../include/dag.h"
+#include "../include/serial.h"
+#include "../include/gg.h"
+#include <fstream>
+#include <filesystem>
+#include <set>
+
+namespace fs = std::filesystem;
+
+// A path and each directory above it ("a/b/c" -> "a/b/c", "a/b", "a")
+static void add_path_and_parents(const std::string& path, std::set<std::string>& keys) {
+    std::string key = path;
+    while (!key.empty()) {
+        if (!keys.insert(key).second) {
+            return; // Parents already added by a sibling
+        }
+        size_t slash = key.rfind('/');
+        if (slash == std::string::npos) {
+            return;
+        }
+        key.resize(slash);
+    }
+}
+
+// ChangedPathIndex implementation
+bool ChangedPathIndex::load(const std::string& filepath) {
+    filters.clear();
+
+    std::string data = read_file_contents(filepath);
+    BinaryReader reader(data);
+    if (!reader.read_header("GGCP")) {
+        return false;
+    }
+
+    // A commit interrupted mid-append leaves a truncated final record
+    while (reader.ok() && !reader.at_end()) {
+        std::string commit_id = reader.read_string();
+        bool too_many = reader.read_u8() != 0;
+        std::string filter_data = reader.read_string();
+        if (!reader.ok()) {
+            break;
+        }
+        if (!too_many) {
+            filters.emplace(commit_id, BlockedBloomFilter::deserialize(filter_data));
+        }
+    }
+    return true;
+}
+
+bool ChangedPathIndex::append(const Commit& commit, const std::string& filepath) {
+    std::set<std::string> keys;
+    for (const auto& [path, blob_id] : commit.file_snapshots) {
+        add_path_and_parents(path, keys);
+    }
+
+    BinaryWriter writer;
+    std::error_code ec;
+    if (!fs::exists(filepath, ec) || fs::file_size(filepath, ec) == 0) {
+        writer.write_header("GGCP");
+    }
+    writer.write_string(commit.id);
+    if (keys.size() > MAX_CHANGED_PATHS) {
+        writer.write_u8(1);
+        writer.write_string("");
+    } else {
+        BlockedBloomFilter filter(keys.size() * BITS_PER_PATH, PATH_HASHES);
+        for (const auto& key : keys) {
+            filter.add(key);
+        }
+        writer.write_u8(0);
+        writer.write_string(filter.serialize());
+    }
+
+    std::ofstream file(filepath, std::ios::binary | std::ios::app);
+    file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+    return static_cast<bool>(file);
+}
+
+bool ChangedPathIndex::might_change(const std::string& commit_id, const std::string& path) const {
+    auto it = filters.find(commit_id);
+    if (it == filters.end()) {
+        return true;
+    }
+    return it->second.might_contain(path);
+}
+
+bool ChangedPathIndex::changes(const Commit& commit, const std::string& path) {
+    if (commit.file_snapshots.count(path)) {
+        return true;
+    }
+    
+    // Snapshots are sorted, so files under a directory follow "dir/"
+    std::string dir = path + "/";
+    auto it = commit.file_snapshots.lower_bound(dir);
+    return it != commit.file_snapshots.end() && it->first.compare(0, dir.size(), dir) == 0;
+}
+
+size_t ChangedPathIndex::size() const {
+    return filters.size();
+}
@@ -0,0 +1,182 @@
+/**
+ * reachability.cpp - Reachability bitmaps for branch tips
+ *
+ * Parents always have smaller indices than their children, so the commits
+ * reachable from commit i fit in a bitmap of i + 1 bits, and computing the
+ * sample bitmaps in index order lets each one stop at the samples below it.
+ */
+
+#include "../include/reachability.h"
+#include "../include/serial.h"
+#include <set>
+
+// ReachabilityIndex implementation
+ReachabilityIndex::ReachabilityIndex() : covered(0), dirty(false) {}
+
+EWAHBitmap ReachabilityIndex::reachable_from(const DAG& dag, CommitIndex commit) const {
+    if (commit >= dag.size()) {
+        return EWAHBitmap();
+    }
+
+    auto stored = bitmaps.find(commit);
+    if (stored != bitmaps.end()) {
+        return stored->second;
+    }
+
+    // Walk down until commits with a bitmap, which are merged in whole;
+    // their bits then stop the walk from entering what they cover
+    std::vector<uint64_t> dense(commit / 64 + 1, 0);
+    std::vector<CommitIndex> stack = {commit};
+    while (!stack.empty()) {
+        CommitIndex index = stack.back();
+        stack.pop_back();
+        if ((dense[index / 64] >> (index % 64)) & 1) {
+            continue;
+        }
+
+        auto it = bitmaps.find(index);
+        if (it != bitmaps.end()) {
+            it->second.or_into(dense);
+            continue;
+        }
+        dense[index / 64] |= 1ULL << (index % 64);
+        for (CommitIndex parent : dag.parents(index)) {
+            if (!((dense[parent / 64] >> (parent % 64)) & 1)) {
+                stack.push_back(parent);
+            }
+        }
+    }
+
+    return EWAHBitmap::from_words(dense, static_cast<size_t>(commit) + 1);
+}
+
+void ReachabilityIndex::update(const DAG& dag, const std::vector<CommitIndex>& tips) {
+    if (covered > dag.size() || (covered > 0 && dag.commit_at(covered - 1).id != last_id)) {
+        bitmaps.clear();
+        covered = 0;
+        dirty = true;
+    }
+    if (covered != dag.size()) {
+        dirty = true;
+    }
+
+    // Samples first, oldest first, so each builds on the ones below it
+    for (CommitIndex index = static_cast<CommitIndex>(covered); index < dag.size(); ++index) {
+        if ((index + 1) % SAMPLE_INTERVAL == 0) {
+            bitmaps[index] = reachable_from(dag, index);
+        }
+    }
+
+    std::set<CommitIndex> wanted;
+    for (CommitIndex tip : tips) {
+        if (tip < dag.size()) {
+            wanted.insert(tip);
+        }
+    }
+    for (CommitIndex tip : wanted) {
+        if (!bitmaps.count(tip)) {
+            bitmaps[tip] = reachable_from(dag, tip);
+            dirty = true;
+        }
+    }
+
+    // Tips that moved on; nothing below depends on them, since a bitmap
+    // is the full set and not a delta
+    for (auto it = bitmaps.begin(); it != bitmaps.end(); ) {
+        if ((it->first + 1) % SAMPLE_INTERVAL != 0 && !wanted.count(it->first)) {
+            it = bitmaps.erase(it);
+            dirty = true;
+        } else {
+            ++it;
+        }
+    }
+
+    covered = dag.size();
+    last_id = covered > 0 ? dag.commit_at(covered - 1).id : "";
+}
+
+bool ReachabilityIndex::reaches(const DAG& dag, CommitIndex from, CommitIndex target) const {
+    // Ancestors always have smaller indices
+    if (from >= dag.size() || target > from) {
+        return false;
+    }
+    return reachable_from(dag, from).get(target);
+}
+
+std::pair<size_t, size_t> ReachabilityIndex::ahead_behind(const DAG& dag, CommitIndex ours, CommitIndex theirs) const {
+    return ahead_behind(reachable_from(dag, ours), reachable_from(dag, theirs));
+}
+
+std::pair<size_t, size_t> ReachabilityIndex::ahead_behind(const EWAHBitmap& ours, const EWAHBitmap& theirs) {
+    return {ours.logical_andnot(theirs).count(), theirs.logical_andnot(ours).count()};
+}
+
+std::vector<CommitIndex> ReachabilityIndex::difference(const DAG& dag, CommitIndex ours, CommitIndex theirs) const {
+    std::vector<CommitIndex> result;
+    reachable_from(dag, ours).logical_andnot(reachable_from(dag, theirs)).for_each([&result](size_t bit) {
+        result.push_back(static_cast<CommitIndex>(bit));
+        return true;
+    });
+    return result;
+}
+
+size_t ReachabilityIndex::size() const {
+    return bitmaps.size();
+}
+
+size_t ReachabilityIndex::size_in_bytes() const {
+    size_t total = 0;
+    for (const auto& [index, bitmap] : bitmaps) {
+        total += bitmap.size_in_bytes();
+    }
+    return total;
+}
+
+bool ReachabilityIndex::is_dirty() const {
+    return dirty;
+}
+
+void ReachabilityIndex::clear_dirty() {
+    dirty = false;
+}
+
+std::string ReachabilityIndex::serialize() const {
+    BinaryWriter writer;
+    writer.write_header("GGRB");
+    writer.write_string(last_id);
+    writer.write_u32(static_cast<uint32_t>(covered));
+    writer.write_u32(static_cast<uint32_t>(bitmaps.size()));
+    for (const auto& [index, bitmap] : bitmaps) {
+        writer.write_u32(index);
+        writer.write_string(bitmap.serialize());
+    }
+    return writer.data();
+}
+
+ReachabilityIndex ReachabilityIndex::deserialize(const std::string& data) {
+    ReachabilityIndex index;
+    BinaryReader reader(data);
+    if (!reader.read_header("GGRB")) {
+        return index;
+    }
+
+    std::string last_id = reader.read_string();
+    uint32_t covered = reader.read_u32();
+    uint32_t count = reader.read_u32();
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        CommitIndex commit = reader.read_u32();
+        std::string bitmap_data = reader.read_string();
+        if (reader.ok()) {
+            index.bitmaps[commit] = EWAHBitmap::deserialize(bitmap_data);
+        }
+    }
+
+    // Anything short of the whole file is rebuilt by update()
+    if (!reader.ok()) {
+        index.bitmaps.clear();
+        return index;
+    }
+    index.last_id = last_id;
+    index.covered = covered;
+    return index;
+}
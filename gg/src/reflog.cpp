@@ -0,0 +1,157 @@
+/**
+ * reflog.cpp - Append-only logs of branch and HEAD movements
+ *
+ * A record is 128 bytes: the old and new commit ids as raw digests (zeros
+ * for none), the time as a little-endian 64-bit integer, and the reason.
+ * A write cut short by a crash leaves a partial record at the end, which
+ * readers ignore and the next append truncates away.
+ */
+
+#include "../include/reflog.h"
+#include "../include/refs.h"
+#include "../include/serial.h"
+#include "../include/hash.h"
+#include "../include/gg.h"
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <climits>
+
+namespace fs = std::filesystem;
+
+static std::string encode_id(const std::string& id) {
+    std::string raw = hex_to_bytes(id);
+    raw.resize(Reflog::ID_SIZE, '\0');
+    return raw;
+}
+
+static std::string decode_id(const std::string& raw) {
+    if (raw.find_first_not_of('\0') == std::string::npos) {
+        return std::string();
+    }
+    return bytes_to_hex(raw);
+}
+
+static ReflogEntry decode_record(const char* record) {
+    ReflogEntry entry;
+    entry.old_id = decode_id(std::string(record, Reflog::ID_SIZE));
+    entry.new_id = decode_id(std::string(record + Reflog::ID_SIZE, Reflog::ID_SIZE));
+    std::string time_bytes(record + 2 * Reflog::ID_SIZE, 8);
+    BinaryReader reader(time_bytes);
+    entry.time = static_cast<int64_t>(reader.read_u64());
+    const char* reason = record + 2 * Reflog::ID_SIZE + 8;
+    entry.reason.assign(reason, std::find(reason, reason + Reflog::REASON_SIZE, '\0'));
+    return entry;
+}
+
+// Reflog implementation
+Reflog::Reflog(const std::string& path) : path(path) {}
+
+Reflog Reflog::for_head() {
+    return Reflog(std::string(REFLOG_DIR) + "/HEAD");
+}
+
+Reflog Reflog::for_branch(const std::string& branch_name) {
+    // A name too long to escape into one file name is cut short and given
+    // its hash instead; "%~" never occurs in an escaped name, so the result
+    // cannot collide with another branch's log
+    std::string file_name = escape_ref_name(branch_name);
+    if (file_name.size() > NAME_MAX) {
+        std::string hash = sha256_hex(branch_name);
+        file_name = file_name.substr(0, NAME_MAX - hash.size() - 2) + "%~" + hash;
+    }
+    return Reflog(std::string(REFLOG_DIR) + "/refs/heads/" + file_name);
+}
+
+bool Reflog::append(const std::string& old_id, const std::string& new_id, const std::string& reason) {
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    // Drop a partial record left by an interrupted append, and never let
+    // the time go backwards (the clock may have), so the log stays sorted
+    size_t count = size();
+    int64_t time = parse_timestamp(get_current_time_string());
+    if (count > 0) {
+        fs::resize_file(path, HEADER_SIZE + count * RECORD_SIZE, ec);
+        std::vector<ReflogEntry> last = read(count - 1, count);
+        if (!last.empty()) {
+            time = std::max(time, last[0].time);
+        }
+    }
+
+    BinaryWriter writer;
+    if (count == 0) {
+        writer.write_header("GGRL");
+    }
+    std::string record = encode_id(old_id) + encode_id(new_id);
+    writer.write_bytes(record.data(), record.size());
+    writer.write_u64(static_cast<uint64_t>(time));
+    std::string padded = reason.substr(0, REASON_SIZE);
+    padded.resize(REASON_SIZE, '\0');
+    writer.write_bytes(padded.data(), padded.size());
+
+    std::ofstream file(path, std::ios::binary | (count == 0 ? std::ios::trunc : std::ios::app));
+    file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size()));
+    file.close();
+    return static_cast<bool>(file);
+}
+
+size_t Reflog::size() const {
+    std::error_code ec;
+    uintmax_t bytes = fs::file_size(path, ec);
+    if (ec || bytes < HEADER_SIZE) {
+        return 0;
+    }
+    return static_cast<size_t>((bytes - HEADER_SIZE) / RECORD_SIZE);
+}
+
+std::vector<ReflogEntry> Reflog::read(size_t begin, size_t end) const {
+    std::vector<ReflogEntry> entries;
+    end = std::min(end, size());
+    if (begin >= end) {
+        return entries;
+    }
+
+    std::string data((end - begin) * RECORD_SIZE, '\0');
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(HEADER_SIZE + begin * RECORD_SIZE));
+    file.read(&data[0], static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        return entries;
+    }
+
+    entries.reserve(end - begin);
+    for (size_t offset = 0; offset < data.size(); offset += RECORD_SIZE) {
+        entries.push_back(decode_record(data.data() + offset));
+    }
+    return entries;
+}
+
+size_t Reflog::find_at(int64_t time) const {
+    std::ifstream file(path, std::ios::binary);
+    std::string header(HEADER_SIZE, '\0');
+    file.read(&header[0], HEADER_SIZE);
+    BinaryReader header_reader(header);
+    if (!file || !header_reader.read_header("GGRL")) {
+        return NO_ENTRY;
+    }
+
+    // Find the first record after time; the one before it is the answer.
+    // Each probe reads one record.
+    size_t low = 0;
+    size_t high = size();
+    char record[RECORD_SIZE];
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        file.seekg(static_cast<std::streamoff>(HEADER_SIZE + middle * RECORD_SIZE));
+        if (!file.read(record, RECORD_SIZE)) {
+            return NO_ENTRY;
+        }
+        if (decode_record(record).time <= time) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low == 0 ? NO_ENTRY : low - 1;
+}
@@ -0,0 +1,167 @@
+/**
+ * refs.cpp - Packed and loose branch refs
+ *
+ * A loose ref holds one branch's commit and times; an empty commit id
+ * records a deleted branch until the next pack.
+ */
+
+#include "../include/refs.h"
+#include "../include/avl.h"
+#include "../include/serial.h"
+#include "../include/gg.h"
+#include <iostream>
+#include <filesystem>
+#include <cctype>
+#include <climits>
+
+namespace fs = std::filesystem;
+
+// Where branches were kept before packed refs; read once and packed over
+static const char* LEGACY_BRANCHES_FILE = ".gg/avl";
+
+// Longest escaped name a loose ref can have, leaving room for the ".tmp"
+// suffix write_file_contents writes through
+static const size_t MAX_LOOSE_NAME = NAME_MAX - 4;
+
+std::string escape_ref_name(const std::string& name) {
+    static const char hex_chars[] = "0123456789ABCDEF";
+    std::string escaped;
+    escaped.reserve(name.size());
+    for (unsigned char c : name) {
+        if (c == '/' || c == '.' || c == '%') {
+            escaped += '%';
+            escaped += hex_chars[c >> 4];
+            escaped += hex_chars[c & 0xf];
+        } else {
+            escaped += static_cast<char>(c);
+        }
+    }
+    return escaped;
+}
+
+static std::string unescape_ref_name(const std::string& escaped) {
+    std::string name;
+    name.reserve(escaped.size());
+    for (size_t i = 0; i < escaped.size(); ++i) {
+        if (escaped[i] == '%' && i + 2 < escaped.size() && std::isxdigit(static_cast<unsigned char>(escaped[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(escaped[i + 2]))) {
+            name += static_cast<char>(std::stoi(escaped.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            name += escaped[i];
+        }
+    }
+    return name;
+}
+
+// RefStore implementation
+RefStore::RefStore(const std::string& packed_path, const std::string& loose_dir)
+    : packed_path(packed_path), loose_dir(loose_dir), needs_pack(false) {}
+
+std::string RefStore::loose_path(const std::string& branch_name) const {
+    return loose_dir + "/" + escape_ref_name(branch_name);
+}
+
+AVLTree RefStore::load() {
+    std::string packed = read_file_contents(packed_path);
+    needs_pack = packed.empty();
+    if (needs_pack) {
+        packed = read_file_contents(LEGACY_BRANCHES_FILE);
+    }
+    AVLTree tree = AVLTree::deserialize(packed);
+
+    // Loose refs replace their packed entries
+    loose_names.clear();
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(loose_dir, ec)) {
+        std::string file_name = entry.path().filename().string();
+        // Skip half-written files; a real ref's name has no '.' left
+        if (!entry.is_regular_file(ec) || file_name.find('.') != std::string::npos) {
+            continue;
+        }
+
+        std::string data = read_file_contents(entry.path().string());
+        BinaryReader reader(data);
+        if (!reader.read_header("GGRF")) {
+            continue;
+        }
+        BranchInfo branch;
+        branch.name = unescape_ref_name(file_name);
+        branch.commit_id = reader.read_string();
+        branch.creation_time = reader.read_string();
+        branch.latest_commit_time = reader.read_string();
+        branch.commit_time = parse_timestamp(branch.latest_commit_time);
+        if (!reader.ok()) {
+            continue;
+        }
+
+        loose_names.insert(branch.name);
+        tree.remove(branch.name);
+        if (!branch.commit_id.empty()) {
+            tree.insert(branch);
+        }
+    }
+
+    tree.clear_changed();
+    return tree;
+}
+
+bool RefStore::save(AVLTree& branches) {
+    const std::set<std::string>& changed = branches.changed_branches();
+    size_t new_loose = 0;
+    for (const auto& name : changed) {
+        new_loose += loose_names.count(name) == 0;
+    }
+    if (needs_pack || loose_names.size() + new_loose > MAX_LOOSE_REFS) {
+        return pack(branches);
+    }
+
+    // A name too long for a single file can only be kept in the packed file
+    for (const auto& name : changed) {
+        if (escape_ref_name(name).size() > MAX_LOOSE_NAME) {
+            return pack(branches);
+        }
+    }
+
+    std::error_code ec;
+    fs::create_directories(loose_dir, ec);
+    for (const auto& name : changed) {
+        const BranchInfo* branch = branches.find(name);
+        BinaryWriter writer;
+        writer.write_header("GGRF");
+        writer.write_string(branch ? branch->commit_id : "");
+        writer.write_string(branch ? branch->creation_time : "");
+        writer.write_string(branch ? branch->latest_commit_time : "");
+        if (!write_file_contents(loose_path(name), writer.data())) {
+            // The packed file holds every branch, including those whose
+            // loose refs were already written
+            return pack(branches);
+        }
+        loose_names.insert(name);
+    }
+    branches.clear_changed();
+    return true;
+}
+
+bool RefStore::pack(AVLTree& branches) {
+    // The loose refs are only deleted once the packed file holds them
+    std::string data = branches.serialize();
+    std::error_code ec;
+    if (!write_file_contents(packed_path, data) || fs::file_size(packed_path, ec) != data.size() || ec) {
+        std::cerr << "Error: Could not write " << packed_path << std::endl;
+        return false;
+    }
+
+    for (const auto& name : loose_names) {
+        fs::remove(loose_path(name), ec);
+    }
+    loose_names.clear();
+    fs::remove(LEGACY_BRANCHES_FILE, ec);
+    needs_pack = false;
+    branches.clear_changed();
+    return true;
+}
+
+size_t RefStore::loose_refs() const {
+    return loose_names.size();
+}
@@ -0,0 +1,49 @@
+/**
+ * revwalk.cpp - Lazy revision walker
+ */
+
+#include "../include/revwalk.h"
+#include "../include/generation.h"
+
+// Highest generation on top; dates and then indices break ties
+bool RevisionWalker::Order::operator()(CommitIndex a, CommitIndex b) const {
+    if (generations->generation(a) != generations->generation(b)) {
+        return generations->generation(a) < generations->generation(b);
+    }
+    if (generations->date(a) != generations->date(b)) {
+        return generations->date(a) < generations->date(b);
+    }
+    return a < b;
+}
+
+// RevisionWalker implementation
+RevisionWalker::RevisionWalker(const DAG& dag, const GenerationIndex& generations)
+    : dag(dag), queue(Order{&generations}), yielded(0) {}
+
+void RevisionWalker::push(CommitIndex tip) {
+    if (tip < dag.size() && seen.insert(tip).second) {
+        queue.push(tip);
+    }
+}
+
+CommitIndex RevisionWalker::next() {
+    if (queue.empty()) {
+        return NO_COMMIT;
+    }
+
+    CommitIndex index = queue.top();
+    queue.pop();
+    for (CommitIndex parent : dag.parents(index)) {
+        push(parent);
+    }
+    yielded++;
+    return index;
+}
+
+bool RevisionWalker::done() const {
+    return queue.empty();
+}
+
+size_t RevisionWalker::count() const {
+    return yielded;
+}
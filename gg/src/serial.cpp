@@ -0,0 +1,163 @@
+/**
+ * serial.cpp - Binary encoding for persisted data structures
+ *
+ * Implements the little-endian writer and bounds-checked reader used by
+ * the serialize()/deserialize() methods of every data structure, and the
+ * timestamp parser that turns stored dates into sortable integers.
+ */
+
+#include "../include/serial.h"
+#include <cstring>
+#include <cstdio>
+
+// BinaryWriter implementation
+void BinaryWriter::write_header(const char tag[4], uint32_t version) {
+    buffer.append(tag, 4);
+    write_u32(version);
+}
+
+void BinaryWriter::write_u8(uint8_t value) {
+    buffer.push_back(static_cast<char>(value));
+}
+
+void BinaryWriter::write_u32(uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+    buffer.append(bytes, 4);
+}
+
+void BinaryWriter::write_u64(uint64_t value) {
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+    buffer.append(bytes, 8);
+}
+
+void BinaryWriter::write_string(const std::string& value) {
+    write_u32(static_cast<uint32_t>(value.size()));
+    buffer.append(value);
+}
+
+void BinaryWriter::write_bytes(const char* data, size_t length) {
+    buffer.append(data, length);
+}
+
+// BinaryReader implementation
+BinaryReader::BinaryReader(const std::string& data) : buffer(data), pos(0), failed(false) {
+}
+
+bool BinaryReader::require(size_t length) {
+    if (failed || length > buffer.size() - pos) {
+        failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool BinaryReader::read_header(const char tag[4], uint32_t max_version) {
+    if (!require(4) || std::memcmp(buffer.data() + pos, tag, 4) != 0) {
+        failed = true;
+        return false;
+    }
+    pos += 4;
+
+    uint32_t version = read_u32();
+    if (!ok() || version == 0 || version > max_version) {
+        failed = true;
+        return false;
+    }
+    return true;
+}
+
+uint8_t BinaryReader::read_u8() {
+    if (!require(1)) return 0;
+    return static_cast<uint8_t>(buffer[pos++]);
+}
+
+uint32_t BinaryReader::read_u32() {
+    if (!require(4)) return 0;
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(buffer[pos + i])) << (8 * i);
+    }
+    pos += 4;
+    return value;
+}
+
+uint64_t BinaryReader::read_u64() {
+    if (!require(8)) return 0;
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(buffer[pos + i])) << (8 * i);
+    }
+    pos += 8;
+    return value;
+}
+
+std::string BinaryReader::read_string() {
+    uint32_t length = read_u32();
+    return read_bytes(length);
+}
+
+std::string BinaryReader::read_bytes(size_t length) {
+    if (!require(length)) return std::string();
+    std::string value = buffer.substr(pos, length);
+    pos += length;
+    return value;
+}
+
+// Commit timestamps are "YYYY-MM-DD HH:MM:SS" in local time. They are
+// converted as if they were UTC, which keeps their order and avoids a
+// time zone lookup per commit; unparsable ones sort first.
+int64_t parse_timestamp(const std::string& timestamp) {
+    static const char* FORMAT = "dddd-dd-dd dd:dd:dd";
+    if (timestamp.size() != 19) {
+        return 0;
+    }
+    int fields[6] = {0, 0, 0, 0, 0, 0};
+    for (size_t i = 0, field = 0; i < timestamp.size(); ++i) {
+        if (FORMAT[i] != 'd') {
+            if (timestamp[i] != FORMAT[i]) return 0;
+            field++;
+        } else if (timestamp[i] >= '0' && timestamp[i] <= '9') {
+            fields[field] = fields[field] * 10 + (timestamp[i] - '0');
+        } else {
+            return 0;
+        }
+    }
+
+    // Days since 1970-01-01 in the proleptic Gregorian calendar
+    int64_t year = fields[0] - (fields[1] <= 2 ? 1 : 0);
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t year_of_era = year - era * 400;
+    int64_t day_of_year = (153 * (fields[1] + (fields[1] > 2 ? -3 : 9)) + 2) / 5 + fields[2] - 1;
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    int64_t days = era * 146097 + day_of_era - 719468;
+    return days * 86400 + fields[3] * 3600 + fields[4] * 60 + fields[5];
+}
+
+std::string format_timestamp(int64_t seconds) {
+    int64_t days = (seconds >= 0 ? seconds : seconds - 86399) / 86400;
+    int64_t second_of_day = seconds - days * 86400;
+
+    // Civil date from days since 1970-01-01, the reverse of the above
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t day_of_era = days - era * 146097;
+    int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int64_t month_index = (5 * day_of_year + 2) / 153;
+    int64_t day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    int64_t month = month_index < 10 ? month_index + 3 : month_index - 9;
+    int64_t year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+
+    char buffer[96];
+    std::snprintf(buffer, sizeof(buffer), "%04lld-%02lld-%02lld %02lld:%02lld:%02lld",
+                  static_cast<long long>(year), static_cast<long long>(month), static_cast<long long>(day),
+                  static_cast<long long>(second_of_day / 3600), static_cast<long long>(second_of_day / 60 % 60),
+                  static_cast<long long>(second_of_day % 60));
+    return buffer;
+}
@@ -2,17 +2,24 @@
  * status.cpp - Implementation of the 'gg status' command
  * 
  * Displays the current status of the repository, showing staged,
- * modified, and untracked files using Trie and Bloom Filter.
+ * modified, deleted, and untracked files using Trie and Cuckoo Filter.
  */
 
 #include "../include/gg.h"
 #include "../include/trie.h"
-#include "../include/bloom.h"
+#include "../include/cuckoo.h"
 #include "../include/avl.h"
 #include "../include/dag.h"
+#include "../include/index.h"
+#include "../include/objects.h"
+#include "../include/walker.h"
+#include "../include/monitor.h"
+#include "../include/ignore.h"
+#include "../include/serial.h"
 #include <iostream>
 #include <filesystem>
 #include <vector>
+#include <set>
 #include <algorithm>
 #include <ncurses.h>
 
@@ -30,53 +37,209 @@ const std::vector<std::string> QuipGenerator::status_quips = {
     "Status: Things could be worse. They could also be better. Much better."
 };
 
-// Helper function to compare the current file state with the repo state
-std::vector<std::string> find_modified_files(const GGRepo& repo) {
+// Committed and staged files are the ones status compares with the worktree
+static bool is_in_repository(FileStatus status) {
+    return status == FileStatus::COMMITTED || status == FileStatus::STAGED;
+}
+
+// Helper function to compare the current file state with the repo state.
+// The index's stat cache means only files whose stat data changed are read.
+// Tracked files missing from the worktree are collected in deleted.
+std::vector<std::string> find_modified_files(const GGRepo& repo, std::vector<std::string>& deleted) {
     std::vector<std::string> modified;
-    std::vector<std::pair<std::string, FileStatus>> all_files = repo.file_trie->get_all_files();
-    
-    for (const auto& [file, status] : all_files) {
-        if (status == FileStatus::COMMITTED && fs::exists(file)) {
-            // In a real implementation, we would hash the file contents and compare
-            // with the stored hash to detect modifications
-            // For this demo, we'll just pretend some are modified
-            if (file.length() % 3 == 0) { // Arbitrary condition for demo
-                modified.push_back(file);
-            }
+    ObjectStore store;
+    
+    repo.file_trie->for_each_file([&](const std::string& file, FileStatus status) {
+        if (!is_in_repository(status)) {
+            return true;
         }
+        std::error_code ec;
+        if (!fs::exists(file, ec)) {
+            deleted.push_back(file);
+        } else if (repo.index->check_modified(file, store)) {
+            modified.push_back(file);
+        }
+        return true;
+    });
+    
+    // Persist refreshed stat data so the next status is stat-only
+    if (repo.index->is_dirty()) {
+        repo.index->save();
     }
     
     return modified;
 }
 
 // Helper function to find untracked files
-std::vector<std::string> find_untracked_files(const GGRepo& repo) {
+std::vector<std::string> find_untracked_files(const GGRepo& repo, IgnoreMatcher& ignore) {
+    ParallelWalker walker;
+    
+    // Never descend into the repository's own metadata or ignored directories
+    ignore.set_worker_count(walker.get_thread_count());
+    walker.set_directory_filter([&ignore](const std::string& dir, size_t worker) {
+        return dir == ".gg" || ignore.is_ignored(dir, true, worker);
+    });
+    
+    // The cuckoo filter answers "definitely not tracked" without touching
+    // the Trie; only possible hits need the exact Trie lookup. Ignore
+    // patterns apply to untracked files only.
+    walker.set_file_filter([&repo, &ignore](const std::string& path, size_t worker) {
+        return (!repo.file_filter->might_contain(path) || !repo.file_trie->search(path)) &&
+               !ignore.is_ignored(path, false, worker);
+    });
+    
+    std::vector<std::string> untracked = walker.walk(".");
+    ignore.save_cache();
+    return untracked;
+}
+
+// Result of the previous status, tagged with the journal position it covers
+struct StatusCache {
+    uint64_t epoch = 0;
+    uint64_t token = 0;
+    std::string ignore_signature;
+    std::vector<std::string> modified;
+    std::vector<std::string> deleted;
     std::vector<std::string> untracked;
+};
+
+static bool load_status_cache(StatusCache& cache) {
+    std::string data = read_file_contents(MONITOR_STATUS_FILE);
+    BinaryReader reader(data);
+    if (!reader.read_header("GGSC")) {
+        return false;
+    }
+    
+    cache.epoch = reader.read_u64();
+    cache.token = reader.read_u64();
+    cache.ignore_signature = reader.read_string();
+    uint32_t modified_count = reader.read_u32();
+    for (uint32_t i = 0; i < modified_count && reader.ok(); ++i) {
+        cache.modified.push_back(reader.read_string());
+    }
+    uint32_t deleted_count = reader.read_u32();
+    for (uint32_t i = 0; i < deleted_count && reader.ok(); ++i) {
+        cache.deleted.push_back(reader.read_string());
+    }
+    uint32_t untracked_count = reader.read_u32();
+    for (uint32_t i = 0; i < untracked_count && reader.ok(); ++i) {
+        cache.untracked.push_back(reader.read_string());
+    }
+    return reader.ok();
+}
+
+static void save_status_cache(const StatusCache& cache) {
+    BinaryWriter writer;
+    writer.write_header("GGSC");
+    writer.write_u64(cache.epoch);
+    writer.write_u64(cache.token);
+    writer.write_string(cache.ignore_signature);
+    writer.write_u32(static_cast<uint32_t>(cache.modified.size()));
+    for (const auto& path : cache.modified) {
+        writer.write_string(path);
+    }
+    writer.write_u32(static_cast<uint32_t>(cache.deleted.size()));
+    for (const auto& path : cache.deleted) {
+        writer.write_string(path);
+    }
+    writer.write_u32(static_cast<uint32_t>(cache.untracked.size()));
+    for (const auto& path : cache.untracked) {
+        writer.write_string(path);
+    }
+    write_file_contents(MONITOR_STATUS_FILE, writer.data());
+}
+
+// Recompute status for just the paths the monitor saw change, plus the
+// paths the previous status reported. Returns false when the journal
+// cannot vouch for everything since the cached result.
+static bool find_changes_incremental(const GGRepo& repo, const ChangeJournal& journal,
+                                     IgnoreMatcher& ignore,
+                                     std::vector<std::string>& modified,
+                                     std::vector<std::string>& deleted,
+                                     std::vector<std::string>& untracked) {
+    StatusCache cache;
+    if (!load_status_cache(cache) || cache.ignore_signature != ignore.get_signature()) {
+        return false;
+    }
+    
+    std::set<std::string> candidates;
+    if (!journal.changes_since(cache.epoch, cache.token, candidates)) {
+        return false;
+    }
+    candidates.insert(cache.modified.begin(), cache.modified.end());
+    candidates.insert(cache.deleted.begin(), cache.deleted.end());
+    candidates.insert(cache.untracked.begin(), cache.untracked.end());
     
-    // Recursively iterate through the current directory
-    for (const auto& entry : fs::recursive_directory_iterator(".")) {
-        if (fs::is_regular_file(entry)) {
-            std::string path = entry.path().string();
-            
-            // Skip files in .gg directory
-            if (path.find(".gg/") == 0 || path.find("\\.gg\\") == 0) {
-                continue;
+    ObjectStore store;
+    std::set<std::string> missing;
+    for (const auto& path : candidates) {
+        if (path.compare(0, 4, ".gg/") == 0) {
+            continue;
+        }
+        std::error_code ec;
+        fs::file_status file_status = fs::status(path, ec);
+        bool tracked = repo.file_filter->might_contain(path) && repo.file_trie->search(path);
+        if (!fs::exists(file_status)) {
+            // A vanished path may be a tracked file or a whole tracked directory
+            if (tracked && is_in_repository(repo.file_trie->get_status(path))) {
+                missing.insert(path);
             }
-            
-            // Check if file is in the Trie
-            if (!repo.file_trie->search(path)) {
-                // Double-check with Bloom filter (demonstrates probabilistic nature)
-                if (!repo.file_filter->might_contain(path)) {
-                    untracked.push_back(path);
-                } else {
-                    // This would be a Bloom filter false positive in a real implementation
-                    // We could add a comment about it but will keep it simple
+            repo.file_trie->for_each_file(path + "/", [&](const std::string& file, FileStatus status) {
+                if (is_in_repository(status) && !fs::exists(file, ec)) {
+                    missing.insert(file);
                 }
+                return true;
+            });
+            continue;
+        }
+        if (!fs::is_regular_file(file_status)) {
+            continue;
+        }
+        if (tracked) {
+            if (repo.index->check_modified(path, store)) {
+                modified.push_back(path);
             }
+        } else if (!ignore.is_path_ignored(path)) {
+            untracked.push_back(path);
         }
     }
     
-    return untracked;
+    deleted.assign(missing.begin(), missing.end());
+    
+    if (repo.index->is_dirty()) {
+        repo.index->save();
+    }
+    return true;
+}
+
+// Find modified and untracked files, asking the monitor's journal first
+// and falling back to a full scan of the worktree
+static void find_changes(const GGRepo& repo, std::vector<std::string>& modified,
+                         std::vector<std::string>& deleted, std::vector<std::string>& untracked) {
+    // Note the journal position before looking at any file, so changes made
+    // during the scan are picked up by the next status
+    ChangeJournal journal;
+    bool monitored = monitor_is_running() && sync_with_monitor(journal);
+    
+    IgnoreMatcher ignore;
+    ignore.load();
+    ignore.load_cache();
+    
+    if (!monitored || !find_changes_incremental(repo, journal, ignore, modified, deleted, untracked)) {
+        modified = find_modified_files(repo, deleted);
+        untracked = find_untracked_files(repo, ignore);
+    }
+    
+    if (monitored) {
+        StatusCache cache;
+        cache.epoch = journal.get_epoch();
+        cache.token = journal.get_latest_token();
+        cache.ignore_signature = ignore.get_signature();
+        cache.modified = modified;
+        cache.deleted = deleted;
+        cache.untracked = untracked;
+        save_status_cache(cache);
+    }
 }
 
 // Display repository status
@@ -92,8 +255,29 @@ void show_status() {
     
     // Get lists of files by status
     std::vector<std::string> staged = repo.file_trie->get_files_by_status(FileStatus::STAGED);
-    std::vector<std::string> modified = find_modified_files(repo);
-    std::vector<std::string> untracked = find_untracked_files(repo);
+    std::vector<std::string> modified;
+    std::vector<std::string> deleted;
+    std::vector<std::string> untracked;
+    find_changes(repo, modified, deleted, untracked);
+    
+    // Headless mode: machine-readable "<code> <path>" lines
+    // (A = staged, M = modified, D = deleted, ? = untracked)
+    if (is_headless_mode()) {
+        std::cout << "## " << repo.current_branch << " " << repo.head_commit << std::endl;
+        for (const auto& file : staged) {
+            std::cout << "A " << file << std::endl;
+        }
+        for (const auto& file : modified) {
+            std::cout << "M " << file << std::endl;
+        }
+        for (const auto& file : deleted) {
+            std::cout << "D " << file << std::endl;
+        }
+        for (const auto& file : untracked) {
+            std::cout << "? " << file << std::endl;
+        }
+        return;
+    }
     
     // Initialize UI
     init_ui();
@@ -104,7 +288,7 @@ void show_status() {
     
     // Display branch and commit info
     BranchInfo* current_branch = repo.branches->find(repo.current_branch);
-    std::shared_ptr<DAGNode> head_commit = repo.commit_graph->get_commit(repo.head_commit);
+    const Commit* head_commit = repo.commit_graph->get_commit(repo.head_commit);
     
     attron(COLOR_PAIR(COLOR_BRANCH));
     mvprintw(2, 2, "On branch: %s", repo.current_branch.c_str());
@@ -113,7 +297,7 @@ void show_status() {
     attron(COLOR_PAIR(COLOR_COMMIT));
     mvprintw(3, 2, "HEAD: %s \"%s\"", 
              repo.head_commit.c_str(), 
-             head_commit ? head_commit->commit.message.c_str() : "unknown");
+             head_commit ? head_commit->message.c_str() : "unknown");
     attroff(COLOR_PAIR(COLOR_COMMIT));
     
     // Display file Trie
@@ -149,7 +333,7 @@ void show_status() {
     mvprintw(row++, col, "Changes not staged for commit:");
     attroff(COLOR_PAIR(COLOR_MODIFIED));
     
-    if (modified.empty()) {
+    if (modified.empty() && deleted.empty()) {
         mvprintw(row++, col + 2, "(none)");
     } else {
         for (const auto& file : modified) {
@@ -157,6 +341,11 @@ void show_status() {
             mvprintw(row++, col + 2, "%s", file.c_str());
             attroff(COLOR_PAIR(COLOR_MODIFIED));
         }
+        for (const auto& file : deleted) {
+            attron(COLOR_PAIR(COLOR_MODIFIED));
+            mvprintw(row++, col + 2, "deleted: %s", file.c_str());
+            attroff(COLOR_PAIR(COLOR_MODIFIED));
+        }
     }
     
     row += 1;
@@ -176,12 +365,12 @@ void show_status() {
         }
     }
     
-    // Display Bloom Filter
-    WINDOW* bloom_win = newwin(7, 40, 21, 2);
-    box(bloom_win, 0, 0);
-    mvwprintw(bloom_win, 0, 2, " File Existence (Bloom Filter) ");
-    repo.file_filter->draw(bloom_win, 1, 2, 36, 5);
-    wrefresh(bloom_win);
+    // Display Cuckoo Filter
+    WINDOW* filter_win = newwin(7, 40, 21, 2);
+    box(filter_win, 0, 0);
+    mvwprintw(filter_win, 0, 2, " File Existence (Cuckoo Filter) ");
+    repo.file_filter->draw(filter_win, 1, 2, 36, 5);
+    wrefresh(filter_win);
     
     // Display success message and a quip
     attron(COLOR_PAIR(COLOR_SUCCESS));
@@ -197,7 +386,7 @@ void show_status() {
     
     // Clean up UI
     delwin(trie_win);
-    delwin(bloom_win);
+    delwin(filter_win);
     cleanup_ui();
 }
 
@@ -1,8 +1,9 @@
 /**
- * stubs.cpp - Stub implementations for data structures
+ * stubs.cpp - SkipList and DisjointSet implementations
  * 
- * This file provides minimal implementations for the data structure classes
- * to satisfy the linker when building on systems without ncurses support.
+ * These data structures have no source file of their own; this file holds
+ * their core operations and binary serialization, plus the learn topic
+ * entry points.
  */
 
 // Define WINDOW type when ncurses is disabled
@@ -15,315 +16,15 @@ typedef struct _win_st WINDOW;
 #include "../include/trie.h"
 #include "../include/skiplist.h"
 #include "../include/disjoint.h"
-#include "../include/bloom.h"
+#include "../include/serial.h"
 #include <iostream>
 #include <sstream>
 #include <queue>
 #include <set>
 #include <cstdlib>
 #include <memory>
-
-// BranchInfo implementation
-BranchInfo::BranchInfo(const std::string& name, const std::string& commit_id, 
-                      const std::string& creation_time) {
-    this->name = name;
-    this->commit_id = commit_id;
-    this->creation_time = creation_time;
-    this->latest_commit_time = creation_time;
-}
-
-// AVLNode implementation
-AVLNode::AVLNode(const BranchInfo& branch) {
-    this->branch = branch;
-    this->height = 1;
-    this->left = nullptr;
-    this->right = nullptr;
-}
-
-int AVLNode::balance_factor() const {
-    int left_height = left ? left->height : 0;
-    int right_height = right ? right->height : 0;
-    return left_height - right_height;
-}
-
-// AVLTree implementation
-AVLTree::AVLTree() {
-    root = nullptr;
-}
-
-bool AVLTree::insert(const BranchInfo& branch) {
-    if (branch_map.find(branch.name) != branch_map.end()) {
-        return false;
-    }
-    
-    root = insert_node(root, branch);
-    return true;
-}
-
-std::shared_ptr<AVLNode> AVLTree::insert_node(std::shared_ptr<AVLNode> node, const BranchInfo& branch) {
-    if (!node) {
-        auto new_node = std::make_shared<AVLNode>(branch);
-        branch_map[branch.name] = new_node;
-        return new_node;
-    }
-    
-    // Simple insertion without balancing for stub implementation
-    if (branch.name < node->branch.name) {
-        node->left = insert_node(node->left, branch);
-    } else if (branch.name > node->branch.name) {
-        node->right = insert_node(node->right, branch);
-    } else {
-        return node; // Duplicate name
-    }
-    
-    return node;
-}
-
-BranchInfo* AVLTree::find(const std::string& branch_name) const {
-    auto it = branch_map.find(branch_name);
-    if (it != branch_map.end()) {
-        return const_cast<BranchInfo*>(&(it->second->branch));
-    }
-    return nullptr;
-}
-
-bool AVLTree::update_commit(const std::string& branch_name, const std::string& commit_id, 
-                          const std::string& commit_time) {
-    BranchInfo* branch = find(branch_name);
-    if (!branch) {
-        return false;
-    }
-    
-    branch->commit_id = commit_id;
-    branch->latest_commit_time = commit_time;
-    return true;
-}
-
-std::vector<BranchInfo> AVLTree::get_all_branches() const {
-    std::vector<BranchInfo> branches;
-    in_order_traversal(root, branches);
-    return branches;
-}
-
-void AVLTree::in_order_traversal(std::shared_ptr<AVLNode> node, std::vector<BranchInfo>& branches) const {
-    if (!node) return;
-    
-    in_order_traversal(node->left, branches);
-    branches.push_back(node->branch);
-    in_order_traversal(node->right, branches);
-}
-
-void AVLTree::draw(WINDOW* win, int start_y, int start_x, const std::string& current_branch) const {
-    // Stub implementation - does nothing in non-ncurses mode
-    (void)win;
-    (void)start_y;
-    (void)start_x;
-    (void)current_branch;
-}
-
-// Commit implementation
-Commit::Commit(const std::string& id, const std::string& message, 
-               const std::string& author, const std::string& timestamp) {
-    this->id = id;
-    this->message = message;
-    this->author = author;
-    this->timestamp = timestamp;
-}
-
-// DAGNode implementation
-DAGNode::DAGNode(const Commit& commit) {
-    this->commit = commit;
-}
-
-void DAGNode::add_parent(std::shared_ptr<DAGNode> parent) {
-    parents.push_back(parent);
-    parent->children.push_back(std::shared_ptr<DAGNode>(this, [](DAGNode*){}));
-}
-
-void DAGNode::add_child(std::shared_ptr<DAGNode> child) {
-    children.push_back(child);
-    child->parents.push_back(std::shared_ptr<DAGNode>(this, [](DAGNode*){}));
-}
-
-// DAG implementation
-DAG::DAG() {
-    head = nullptr;
-}
-
-std::shared_ptr<DAGNode> DAG::add_commit(const Commit& commit, 
-                                       const std::vector<std::string>& parent_ids) {
-    auto node = std::make_shared<DAGNode>(commit);
-    nodes[commit.id] = node;
-    
-    for (const auto& parent_id : parent_ids) {
-        auto parent = get_commit(parent_id);
-        if (parent) {
-            node->add_parent(parent);
-        }
-    }
-    
-    if (parent_ids.empty() || !head) {
-        head = node;
-    }
-    
-    return node;
-}
-
-std::shared_ptr<DAGNode> DAG::get_commit(const std::string& commit_id) const {
-    auto it = nodes.find(commit_id);
-    if (it != nodes.end()) {
-        return it->second;
-    }
-    return nullptr;
-}
-
-bool DAG::set_head(const std::string& commit_id) {
-    auto commit = get_commit(commit_id);
-    if (!commit) {
-        return false;
-    }
-    
-    head = commit;
-    return true;
-}
-
-std::shared_ptr<DAGNode> DAG::get_head() const {
-    return head;
-}
-
-std::vector<std::shared_ptr<DAGNode>> DAG::breadth_first_search() const {
-    std::vector<std::shared_ptr<DAGNode>> result;
-    if (!head) return result;
-    
-    std::queue<std::shared_ptr<DAGNode>> queue;
-    std::set<std::string> visited;
-    
-    queue.push(head);
-    visited.insert(head->commit.id);
-    
-    while (!queue.empty()) {
-        auto node = queue.front();
-        queue.pop();
-        
-        result.push_back(node);
-        
-        for (const auto& child : node->children) {
-            if (visited.find(child->commit.id) == visited.end()) {
-                visited.insert(child->commit.id);
-                queue.push(child);
-            }
-        }
-    }
-    
-    return result;
-}
-
-void DAG::draw(WINDOW* win, const std::string& current_commit) const {
-    // Stub implementation - does nothing in non-ncurses mode
-    (void)win;
-    (void)current_commit;
-}
-
-// Trie implementation
-Trie::Trie() {
-    root = std::make_shared<TrieNode>();
-}
-
-bool Trie::insert(const std::string& path, FileStatus status) {
-    return insert_recursive(root, path, 0, status);
-}
-
-bool Trie::insert_recursive(std::shared_ptr<TrieNode> node, const std::string& path, size_t index, FileStatus status) {
-    if (index == path.length()) {
-        node->is_file_end = true;
-        node->status = status;
-        return true;
-    }
-    
-    char c = path[index];
-    if (node->children.find(c) == node->children.end()) {
-        node->children[c] = std::make_shared<TrieNode>();
-    }
-    
-    return insert_recursive(node->children[c], path, index + 1, status);
-}
-
-bool Trie::search(const std::string& path) const {
-    return search_recursive(root, path, 0);
-}
-
-bool Trie::search_recursive(std::shared_ptr<TrieNode> node, const std::string& path, size_t index) const {
-    if (!node) return false;
-    
-    if (index == path.length()) {
-        return node->is_file_end;
-    }
-    
-    char c = path[index];
-    if (node->children.find(c) == node->children.end()) {
-        return false;
-    }
-    
-    return search_recursive(node->children[c], path, index + 1);
-}
-
-bool Trie::update_status(const std::string& path, FileStatus status) {
-    std::shared_ptr<TrieNode> node = root;
-    
-    for (char c : path) {
-        if (node->children.find(c) == node->children.end()) {
-            return false;
-        }
-        node = node->children[c];
-    }
-    
-    if (!node->is_file_end) {
-        return false;
-    }
-    
-    node->status = status;
-    return true;
-}
-
-std::vector<std::string> Trie::get_files_by_status(FileStatus status) const {
-    std::vector<std::string> files;
-    std::vector<std::pair<std::string, FileStatus>> all_files;
-    get_all_files_recursive(root, "", all_files);
-    
-    for (const auto& file : all_files) {
-        if (file.second == status) {
-            files.push_back(file.first);
-        }
-    }
-    
-    return files;
-}
-
-std::vector<std::pair<std::string, FileStatus>> Trie::get_all_files() const {
-    std::vector<std::pair<std::string, FileStatus>> files;
-    get_all_files_recursive(root, "", files);
-    return files;
-}
-
-void Trie::get_all_files_recursive(std::shared_ptr<TrieNode> node, std::string current_path, 
-                                 std::vector<std::pair<std::string, FileStatus>>& files) const {
-    if (!node) return;
-    
-    if (node->is_file_end) {
-        files.push_back({current_path, node->status});
-    }
-    
-    for (const auto& pair : node->children) {
-        get_all_files_recursive(pair.second, current_path + pair.first, files);
-    }
-}
-
-void Trie::draw(WINDOW* win, int start_y, int start_x) const {
-    // Stub implementation - does nothing in non-ncurses mode
-    (void)win;
-    (void)start_y;
-    (void)start_x;
-}
+#include <cmath>
+#include <algorithm>
 
 // SkipNode implementation
 SkipNode::SkipNode(const std::string& commit_id, const std::string& timestamp, int level) {
@@ -342,6 +43,7 @@ SkipNode::SkipNode() {
 SkipList::SkipList() {
     header = std::make_shared<SkipNode>();
     level = 0;
+    dirty = false;
     rng = std::mt19937(std::random_device()());
     dist = std::uniform_real_distribution<double>(0, 1);
 }
@@ -366,9 +68,18 @@ bool SkipList::insert(const std::string& commit_id, const std::string& timestamp
         }
     }
     
+    dirty = true;
     return true;
 }
 
+bool SkipList::is_dirty() const {
+    return dirty;
+}
+
+void SkipList::clear_dirty() {
+    dirty = false;
+}
+
 void SkipList::draw(WINDOW* win, int start_y, int start_x) const {
     // Stub implementation - does nothing in non-ncurses mode
     (void)win;
@@ -376,6 +87,41 @@ void SkipList::draw(WINDOW* win, int start_y, int start_x) const {
     (void)start_x;
 }
 
+std::string SkipList::serialize() const {
+    uint32_t count = 0;
+    for (auto node = header->forward[0]; node; node = node->forward[0]) {
+        count++;
+    }
+    
+    BinaryWriter writer;
+    writer.write_header("GGSL");
+    writer.write_u32(count);
+    for (auto node = header->forward[0]; node; node = node->forward[0]) {
+        writer.write_string(node->commit_id);
+        writer.write_string(node->timestamp);
+    }
+    return writer.data();
+}
+
+SkipList SkipList::deserialize(const std::string& data) {
+    SkipList list;
+    BinaryReader reader(data);
+    if (!reader.read_header("GGSL")) {
+        return list;
+    }
+    
+    uint32_t count = reader.read_u32();
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        std::string commit_id = reader.read_string();
+        std::string timestamp = reader.read_string();
+        if (reader.ok()) {
+            list.insert(commit_id, timestamp);
+        }
+    }
+    list.dirty = false;
+    return list;
+}
+
 int SkipList::random_level() {
     int lvl = 0;
     while (dist(rng) < 0.5 && lvl < MAX_LEVEL - 1) {
@@ -392,7 +138,7 @@ DisjointNode::DisjointNode(const std::string& key) {
 }
 
 // DisjointSet implementation
-DisjointSet::DisjointSet() {
+DisjointSet::DisjointSet() : dirty(false) {
 }
 
 void DisjointSet::make_set(const std::string& key) {
@@ -403,6 +149,7 @@ void DisjointSet::make_set(const std::string& key) {
     auto node = std::make_shared<DisjointNode>(key);
     node->parent = node; // Point to itself
     nodes[key] = node;
+    dirty = true;
 }
 
 std::shared_ptr<DisjointNode> DisjointSet::find_set_node(std::shared_ptr<DisjointNode> node) {
@@ -447,9 +194,18 @@ bool DisjointSet::union_sets(const std::string& key1, const std::string& key2) {
         root1->rank++;
     }
     
+    dirty = true;
     return true;
 }
 
+bool DisjointSet::is_dirty() const {
+    return dirty;
+}
+
+void DisjointSet::clear_dirty() {
+    dirty = false;
+}
+
 void DisjointSet::draw(WINDOW* win, int start_y, int start_x) const {
     // Stub implementation - does nothing in non-ncurses mode
     (void)win;
@@ -457,78 +213,48 @@ void DisjointSet::draw(WINDOW* win, int start_y, int start_x) const {
     (void)start_x;
 }
 
-// BloomFilter implementation
-BloomFilter::BloomFilter(size_t size) {
-    this->size = size;
-    bit_array.resize(size, false);
-    item_count = 0;
-}
-
-void BloomFilter::add(const std::string& item) {
-    bit_array[hash1(item) % size] = true;
-    bit_array[hash2(item) % size] = true;
-    bit_array[hash3(item) % size] = true;
-    item_count++;
-}
-
-bool BloomFilter::might_contain(const std::string& item) const {
-    return bit_array[hash1(item) % size] && 
-           bit_array[hash2(item) % size] && 
-           bit_array[hash3(item) % size];
-}
-
-void BloomFilter::clear() {
-    bit_array.assign(size, false);
-    item_count = 0;
-}
-
-double BloomFilter::false_positive_probability() const {
-    // Simple approximation of false positive probability
-    double k = HASH_FUNCTIONS;
-    double n = item_count;
-    double m = size;
-    return std::pow(1 - std::exp(-k * n / m), k);
-}
-
-size_t BloomFilter::get_item_count() const {
-    return item_count;
-}
-
-size_t BloomFilter::get_size() const {
-    return size;
-}
-
-size_t BloomFilter::hash1(const std::string& key) const {
-    size_t hash = 0;
-    for (char c : key) {
-        hash = hash * 31 + c;
+std::string DisjointSet::serialize() const {
+    BinaryWriter writer;
+    writer.write_header("GGDS");
+    writer.write_u32(static_cast<uint32_t>(nodes.size()));
+    for (const auto& [key, node] : nodes) {
+        writer.write_string(key);
+        writer.write_string(node->parent ? node->parent->key : key);
+        writer.write_u32(static_cast<uint32_t>(node->rank));
     }
-    return hash;
+    return writer.data();
 }
 
-size_t BloomFilter::hash2(const std::string& key) const {
-    size_t hash = 0;
-    for (char c : key) {
-        hash = hash * 37 + c;
+DisjointSet DisjointSet::deserialize(const std::string& data) {
+    DisjointSet set;
+    BinaryReader reader(data);
+    if (!reader.read_header("GGDS")) {
+        return set;
     }
-    return hash;
-}
-
-size_t BloomFilter::hash3(const std::string& key) const {
-    size_t hash = 0;
-    for (char c : key) {
-        hash = hash * 41 + c;
+    
+    // First pass creates every node, second pass restores parent links
+    std::vector<std::pair<std::string, std::string>> links;
+    uint32_t count = reader.read_u32();
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        std::string key = reader.read_string();
+        std::string parent_key = reader.read_string();
+        int rank = static_cast<int>(reader.read_u32());
+        if (!reader.ok()) {
+            break;
+        }
+        set.make_set(key);
+        set.nodes[key]->rank = rank;
+        links.push_back({key, parent_key});
     }
-    return hash;
-}
-
-void BloomFilter::draw(WINDOW* win, int start_y, int start_x, int width, int height) const {
-    // Stub implementation - does nothing in non-ncurses mode
-    (void)win;
-    (void)start_y;
-    (void)start_x;
-    (void)width;
-    (void)height;
+    
+    for (const auto& [key, parent_key] : links) {
+        auto parent = set.nodes.find(parent_key);
+        if (parent != set.nodes.end()) {
+            set.nodes[key]->parent = parent->second;
+        }
+    }
+    set.dirty = false;
+    return set;
 }
 
 // Learn function implementations
@@ -0,0 +1,864 @@
+/**
+ * trie.cpp - Adaptive radix tree behind the file-tracking Trie
+ *
+ * Paths are keyed byte by byte with an implicit '\0' terminator, so a path
+ * that is a prefix of another (e.g. "a" and "a/b") still ends in its own
+ * leaf. Inner nodes keep up to ART_MAX_PREFIX bytes of their compressed
+ * prefix inline; longer prefixes are skipped optimistically during lookup
+ * and checked against the full path stored in the leaf that is reached.
+ * Lookup, insertion and removal are loops, not recursion; removal shrinks
+ * nodes back down and merges a node left with one child into that child.
+ *
+ * Every inner node also counts the leaves below it per status, so listing
+ * the files with one status skips every subtree that has none.
+ */
+
+#include "../include/trie.h"
+#include "../include/serial.h"
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static const size_t ART_MAX_PREFIX = 10;
+static const size_t FILE_STATUS_COUNT = 4;
+
+enum class ArtNodeType : uint8_t {
+    LEAF,
+    NODE4,
+    NODE16,
+    NODE48,
+    NODE256
+};
+
+struct ArtNode {
+    ArtNodeType type;
+
+    explicit ArtNode(ArtNodeType type) : type(type) {}
+};
+
+struct ArtLeaf : ArtNode {
+    FileStatus status;
+    std::string path;
+
+    ArtLeaf(const std::string& path, FileStatus status)
+        : ArtNode(ArtNodeType::LEAF), status(status), path(path) {}
+};
+
+struct ArtInner : ArtNode {
+    uint16_t num_children = 0;
+    uint32_t prefix_len = 0;
+    uint8_t prefix[ART_MAX_PREFIX] = {};
+    uint32_t status_counts[FILE_STATUS_COUNT] = {}; // Leaves below, per status
+
+    explicit ArtInner(ArtNodeType type) : ArtNode(type) {}
+};
+
+// Up to 4 children, keys kept sorted
+struct ArtNode4 : ArtInner {
+    uint8_t keys[4] = {};
+    ArtNode* children[4] = {};
+
+    ArtNode4() : ArtInner(ArtNodeType::NODE4) {}
+};
+
+// Up to 16 children, keys kept sorted and searched with one SIMD compare
+struct ArtNode16 : ArtInner {
+    uint8_t keys[16] = {};
+    ArtNode* children[16] = {};
+
+    ArtNode16() : ArtInner(ArtNodeType::NODE16) {}
+};
+
+// Up to 48 children, indexed through a 256-entry byte map (0 = empty)
+struct ArtNode48 : ArtInner {
+    uint8_t child_index[256] = {};
+    ArtNode* children[48] = {};
+
+    ArtNode48() : ArtInner(ArtNodeType::NODE48) {}
+};
+
+// One slot per byte value
+struct ArtNode256 : ArtInner {
+    ArtNode* children[256] = {};
+
+    ArtNode256() : ArtInner(ArtNodeType::NODE256) {}
+};
+
+// Key byte at depth, with the terminator past the end of the path
+static inline uint8_t key_at(const std::string& path, size_t depth) {
+    return depth < path.size() ? static_cast<uint8_t>(path[depth]) : 0;
+}
+
+static void free_node(ArtNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case ArtNodeType::LEAF:
+            delete static_cast<ArtLeaf*>(node);
+            return;
+        case ArtNodeType::NODE4: {
+            ArtNode4* n = static_cast<ArtNode4*>(node);
+            for (int i = 0; i < n->num_children; ++i) free_node(n->children[i]);
+            delete n;
+            return;
+        }
+        case ArtNodeType::NODE16: {
+            ArtNode16* n = static_cast<ArtNode16*>(node);
+            for (int i = 0; i < n->num_children; ++i) free_node(n->children[i]);
+            delete n;
+            return;
+        }
+        case ArtNodeType::NODE48: {
+            ArtNode48* n = static_cast<ArtNode48*>(node);
+            for (int i = 0; i < 48; ++i) free_node(n->children[i]);
+            delete n;
+            return;
+        }
+        case ArtNodeType::NODE256: {
+            ArtNode256* n = static_cast<ArtNode256*>(node);
+            for (int i = 0; i < 256; ++i) free_node(n->children[i]);
+            delete n;
+            return;
+        }
+    }
+}
+
+static ArtNode* clone_node(const ArtNode* node) {
+    if (!node) return nullptr;
+
+    switch (node->type) {
+        case ArtNodeType::LEAF:
+            return new ArtLeaf(*static_cast<const ArtLeaf*>(node));
+        case ArtNodeType::NODE4: {
+            ArtNode4* n = new ArtNode4(*static_cast<const ArtNode4*>(node));
+            for (int i = 0; i < n->num_children; ++i) n->children[i] = clone_node(n->children[i]);
+            return n;
+        }
+        case ArtNodeType::NODE16: {
+            ArtNode16* n = new ArtNode16(*static_cast<const ArtNode16*>(node));
+            for (int i = 0; i < n->num_children; ++i) n->children[i] = clone_node(n->children[i]);
+            return n;
+        }
+        case ArtNodeType::NODE48: {
+            ArtNode48* n = new ArtNode48(*static_cast<const ArtNode48*>(node));
+            for (int i = 0; i < 48; ++i) n->children[i] = clone_node(n->children[i]);
+            return n;
+        }
+        case ArtNodeType::NODE256: {
+            ArtNode256* n = new ArtNode256(*static_cast<const ArtNode256*>(node));
+            for (int i = 0; i < 256; ++i) n->children[i] = clone_node(n->children[i]);
+            return n;
+        }
+    }
+    return nullptr;
+}
+
+// Slot holding the child for key, or nullptr
+static ArtNode** find_child(ArtInner* node, uint8_t key) {
+    switch (node->type) {
+        case ArtNodeType::NODE4: {
+            ArtNode4* n = static_cast<ArtNode4*>(node);
+            for (int i = 0; i < n->num_children; ++i) {
+                if (n->keys[i] == key) return &n->children[i];
+            }
+            return nullptr;
+        }
+        case ArtNodeType::NODE16: {
+            ArtNode16* n = static_cast<ArtNode16*>(node);
+#if defined(__SSE2__)
+            __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(key)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys)));
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(cmp)) & ((1u << n->num_children) - 1);
+            return mask ? &n->children[__builtin_ctz(mask)] : nullptr;
+#else
+            for (int i = 0; i < n->num_children; ++i) {
+                if (n->keys[i] == key) return &n->children[i];
+            }
+            return nullptr;
+#endif
+        }
+        case ArtNodeType::NODE48: {
+            ArtNode48* n = static_cast<ArtNode48*>(node);
+            uint8_t index = n->child_index[key];
+            return index ? &n->children[index - 1] : nullptr;
+        }
+        case ArtNodeType::NODE256: {
+            ArtNode256* n = static_cast<ArtNode256*>(node);
+            return n->children[key] ? &n->children[key] : nullptr;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+static void copy_header(ArtInner* dest, const ArtInner* src) {
+    dest->num_children = src->num_children;
+    dest->prefix_len = src->prefix_len;
+    std::memcpy(dest->prefix, src->prefix, ART_MAX_PREFIX);
+    std::memcpy(dest->status_counts, src->status_counts, sizeof(src->status_counts));
+}
+
+static inline size_t status_slot(FileStatus status) {
+    return static_cast<size_t>(status) % FILE_STATUS_COUNT;
+}
+
+// Add the per-status leaf counts of node to counts
+static void add_counts(uint32_t counts[FILE_STATUS_COUNT], const ArtNode* node) {
+    if (node->type == ArtNodeType::LEAF) {
+        counts[status_slot(static_cast<const ArtLeaf*>(node)->status)]++;
+    } else {
+        const ArtInner* inner = static_cast<const ArtInner*>(node);
+        for (size_t i = 0; i < FILE_STATUS_COUNT; ++i) {
+            counts[i] += inner->status_counts[i];
+        }
+    }
+}
+
+// Add a child under a key not yet present, growing the node (and updating
+// the slot that points to it) when it is full
+static void add_child(ArtNode** ref, ArtInner* node, uint8_t key, ArtNode* child) {
+    switch (node->type) {
+        case ArtNodeType::NODE4: {
+            ArtNode4* n = static_cast<ArtNode4*>(node);
+            if (n->num_children < 4) {
+                int pos = 0;
+                while (pos < n->num_children && n->keys[pos] < key) pos++;
+                std::memmove(n->keys + pos + 1, n->keys + pos, n->num_children - pos);
+                std::memmove(n->children + pos + 1, n->children + pos, (n->num_children - pos) * sizeof(ArtNode*));
+                n->keys[pos] = key;
+                n->children[pos] = child;
+                n->num_children++;
+                return;
+            }
+            ArtNode16* grown = new ArtNode16();
+            copy_header(grown, n);
+            std::memcpy(grown->keys, n->keys, 4);
+            std::memcpy(grown->children, n->children, 4 * sizeof(ArtNode*));
+            *ref = grown;
+            delete n;
+            add_child(ref, grown, key, child);
+            return;
+        }
+        case ArtNodeType::NODE16: {
+            ArtNode16* n = static_cast<ArtNode16*>(node);
+            if (n->num_children < 16) {
+                int pos = 0;
+                while (pos < n->num_children && n->keys[pos] < key) pos++;
+                std::memmove(n->keys + pos + 1, n->keys + pos, n->num_children - pos);
+                std::memmove(n->children + pos + 1, n->children + pos, (n->num_children - pos) * sizeof(ArtNode*));
+                n->keys[pos] = key;
+                n->children[pos] = child;
+                n->num_children++;
+                return;
+            }
+            ArtNode48* grown = new ArtNode48();
+            copy_header(grown, n);
+            for (int i = 0; i < 16; ++i) {
+                grown->children[i] = n->children[i];
+                grown->child_index[n->keys[i]] = static_cast<uint8_t>(i + 1);
+            }
+            *ref = grown;
+            delete n;
+            add_child(ref, grown, key, child);
+            return;
+        }
+        case ArtNodeType::NODE48: {
+            ArtNode48* n = static_cast<ArtNode48*>(node);
+            if (n->num_children < 48) {
+                int pos = 0;
+                while (n->children[pos]) pos++;
+                n->children[pos] = child;
+                n->child_index[key] = static_cast<uint8_t>(pos + 1);
+                n->num_children++;
+                return;
+            }
+            ArtNode256* grown = new ArtNode256();
+            copy_header(grown, n);
+            for (int k = 0; k < 256; ++k) {
+                if (n->child_index[k]) {
+                    grown->children[k] = n->children[n->child_index[k] - 1];
+                }
+            }
+            *ref = grown;
+            delete n;
+            add_child(ref, grown, key, child);
+            return;
+        }
+        case ArtNodeType::NODE256: {
+            ArtNode256* n = static_cast<ArtNode256*>(node);
+            n->children[key] = child;
+            n->num_children++;
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+// Leftmost leaf below node; every leaf below shares the node's prefix
+static const ArtLeaf* minimum_leaf(const ArtNode* node) {
+    while (node && node->type != ArtNodeType::LEAF) {
+        switch (node->type) {
+            case ArtNodeType::NODE4:
+                node = static_cast<const ArtNode4*>(node)->children[0];
+                break;
+            case ArtNodeType::NODE16:
+                node = static_cast<const ArtNode16*>(node)->children[0];
+                break;
+            case ArtNodeType::NODE48: {
+                const ArtNode48* n = static_cast<const ArtNode48*>(node);
+                int k = 0;
+                while (!n->child_index[k]) k++;
+                node = n->children[n->child_index[k] - 1];
+                break;
+            }
+            case ArtNodeType::NODE256: {
+                const ArtNode256* n = static_cast<const ArtNode256*>(node);
+                int k = 0;
+                while (!n->children[k]) k++;
+                node = n->children[k];
+                break;
+            }
+            default:
+                return nullptr;
+        }
+    }
+    return static_cast<const ArtLeaf*>(node);
+}
+
+// Number of prefix bytes of node that match path from depth on
+static size_t prefix_mismatch(const ArtInner* node, const std::string& path, size_t depth) {
+    const ArtLeaf* leaf = nullptr;
+    for (size_t i = 0; i < node->prefix_len; ++i) {
+        uint8_t expected;
+        if (i < ART_MAX_PREFIX) {
+            expected = node->prefix[i];
+        } else {
+            // Bytes past the inline part are read from any leaf below
+            if (!leaf) leaf = minimum_leaf(node);
+            expected = key_at(leaf->path, depth + i);
+        }
+        if (expected != key_at(path, depth + i)) {
+            return i;
+        }
+    }
+    return node->prefix_len;
+}
+
+// Remove the child under key, shrinking the node when it falls well below
+// its size class. A Node4 left with one child is replaced by that child,
+// which absorbs the node's prefix and key byte. depth is where the node's
+// prefix starts.
+static void remove_child(ArtNode** ref, ArtInner* node, uint8_t key, size_t depth) {
+    switch (node->type) {
+        case ArtNodeType::NODE4: {
+            ArtNode4* n = static_cast<ArtNode4*>(node);
+            int pos = 0;
+            while (n->keys[pos] != key) pos++;
+            std::memmove(n->keys + pos, n->keys + pos + 1, n->num_children - pos - 1);
+            std::memmove(n->children + pos, n->children + pos + 1, (n->num_children - pos - 1) * sizeof(ArtNode*));
+            n->num_children--;
+            if (n->num_children > 1) {
+                return;
+            }
+
+            ArtNode* only = n->children[0];
+            if (only->type != ArtNodeType::LEAF) {
+                ArtInner* child = static_cast<ArtInner*>(only);
+                const ArtLeaf* leaf = minimum_leaf(child);
+                child->prefix_len += n->prefix_len + 1;
+                for (size_t i = 0; i < std::min<size_t>(child->prefix_len, ART_MAX_PREFIX); ++i) {
+                    child->prefix[i] = key_at(leaf->path, depth + i);
+                }
+            }
+            *ref = only;
+            delete n;
+            return;
+        }
+        case ArtNodeType::NODE16: {
+            ArtNode16* n = static_cast<ArtNode16*>(node);
+            int pos = 0;
+            while (n->keys[pos] != key) pos++;
+            std::memmove(n->keys + pos, n->keys + pos + 1, n->num_children - pos - 1);
+            std::memmove(n->children + pos, n->children + pos + 1, (n->num_children - pos - 1) * sizeof(ArtNode*));
+            n->num_children--;
+            if (n->num_children > 3) {
+                return;
+            }
+
+            ArtNode4* shrunk = new ArtNode4();
+            copy_header(shrunk, n);
+            std::memcpy(shrunk->keys, n->keys, n->num_children);
+            std::memcpy(shrunk->children, n->children, n->num_children * sizeof(ArtNode*));
+            *ref = shrunk;
+            delete n;
+            return;
+        }
+        case ArtNodeType::NODE48: {
+            ArtNode48* n = static_cast<ArtNode48*>(node);
+            n->children[n->child_index[key] - 1] = nullptr;
+            n->child_index[key] = 0;
+            n->num_children--;
+            if (n->num_children > 12) {
+                return;
+            }
+
+            ArtNode16* shrunk = new ArtNode16();
+            copy_header(shrunk, n);
+            int pos = 0;
+            for (int k = 0; k < 256; ++k) {
+                if (n->child_index[k]) {
+                    shrunk->keys[pos] = static_cast<uint8_t>(k);
+                    shrunk->children[pos++] = n->children[n->child_index[k] - 1];
+                }
+            }
+            *ref = shrunk;
+            delete n;
+            return;
+        }
+        case ArtNodeType::NODE256: {
+            ArtNode256* n = static_cast<ArtNode256*>(node);
+            n->children[key] = nullptr;
+            n->num_children--;
+            if (n->num_children > 37) {
+                return;
+            }
+
+            ArtNode48* shrunk = new ArtNode48();
+            copy_header(shrunk, n);
+            int pos = 0;
+            for (int k = 0; k < 256; ++k) {
+                if (n->children[k]) {
+                    shrunk->children[pos] = n->children[k];
+                    shrunk->child_index[k] = static_cast<uint8_t>(++pos);
+                }
+            }
+            *ref = shrunk;
+            delete n;
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+// Exact-match lookup
+static ArtLeaf* find_leaf(ArtNode* node, const std::string& path) {
+    size_t depth = 0;
+    while (node) {
+        if (node->type == ArtNodeType::LEAF) {
+            ArtLeaf* leaf = static_cast<ArtLeaf*>(node);
+            return leaf->path == path ? leaf : nullptr;
+        }
+
+        // Compare the inline prefix bytes; the rest is verified at the leaf
+        ArtInner* inner = static_cast<ArtInner*>(node);
+        size_t inline_len = std::min<size_t>(inner->prefix_len, ART_MAX_PREFIX);
+        for (size_t i = 0; i < inline_len; ++i) {
+            if (inner->prefix[i] != key_at(path, depth + i)) {
+                return nullptr;
+            }
+        }
+        depth += inner->prefix_len;
+        if (depth > path.size()) {
+            return nullptr;
+        }
+
+        ArtNode** child = find_child(inner, key_at(path, depth));
+        node = child ? *child : nullptr;
+        depth++;
+    }
+    return nullptr;
+}
+
+// Move an existing leaf from one status to another, updating the counts
+// of every inner node above it
+static void change_status(ArtNode* node, ArtLeaf* leaf, FileStatus status) {
+    if (leaf->status == status) {
+        return;
+    }
+
+    size_t from = status_slot(leaf->status);
+    size_t to = status_slot(status);
+    size_t depth = 0;
+    while (node != leaf) {
+        ArtInner* inner = static_cast<ArtInner*>(node);
+        inner->status_counts[from]--;
+        inner->status_counts[to]++;
+        depth += inner->prefix_len;
+        node = *find_child(inner, key_at(leaf->path, depth));
+        depth++;
+    }
+    leaf->status = status;
+}
+
+// Visit the leaves below node in path order, optionally only those with
+// one status (skipping subtrees whose count for it is zero). Returns false
+// once the visitor asks to stop.
+static bool visit_subtree(const ArtNode* node, const FileStatus* status, const Trie::FileVisitor& visit) {
+    if (!node) return true;
+
+    if (node->type == ArtNodeType::LEAF) {
+        const ArtLeaf* leaf = static_cast<const ArtLeaf*>(node);
+        if (status && leaf->status != *status) {
+            return true;
+        }
+        return visit(leaf->path, leaf->status);
+    }
+    if (status && static_cast<const ArtInner*>(node)->status_counts[status_slot(*status)] == 0) {
+        return true;
+    }
+
+    switch (node->type) {
+        case ArtNodeType::NODE4: {
+            const ArtNode4* n = static_cast<const ArtNode4*>(node);
+            for (int i = 0; i < n->num_children; ++i) {
+                if (!visit_subtree(n->children[i], status, visit)) return false;
+            }
+            return true;
+        }
+        case ArtNodeType::NODE16: {
+            const ArtNode16* n = static_cast<const ArtNode16*>(node);
+            for (int i = 0; i < n->num_children; ++i) {
+                if (!visit_subtree(n->children[i], status, visit)) return false;
+            }
+            return true;
+        }
+        case ArtNodeType::NODE48: {
+            const ArtNode48* n = static_cast<const ArtNode48*>(node);
+            for (int k = 0; k < 256; ++k) {
+                if (n->child_index[k] && !visit_subtree(n->children[n->child_index[k] - 1], status, visit)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case ArtNodeType::NODE256: {
+            const ArtNode256* n = static_cast<const ArtNode256*>(node);
+            for (int k = 0; k < 256; ++k) {
+                if (n->children[k] && !visit_subtree(n->children[k], status, visit)) return false;
+            }
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+// Trie implementation
+Trie::Trie() : root(nullptr), file_count(0), dirty(false) {
+}
+
+Trie::Trie(const Trie& other) : root(clone_node(other.root)), file_count(other.file_count), dirty(other.dirty) {
+}
+
+Trie::Trie(Trie&& other) noexcept : root(other.root), file_count(other.file_count), dirty(other.dirty) {
+    other.root = nullptr;
+    other.file_count = 0;
+    other.dirty = false;
+}
+
+Trie& Trie::operator=(Trie other) {
+    std::swap(root, other.root);
+    std::swap(file_count, other.file_count);
+    std::swap(dirty, other.dirty);
+    return *this;
+}
+
+Trie::~Trie() {
+    free_node(root);
+}
+
+bool Trie::insert(const std::string& path, FileStatus status) {
+    // Re-inserting a known path only changes its status
+    if (ArtLeaf* existing = find_leaf(root, path)) {
+        if (existing->status != status) {
+            change_status(root, existing, status);
+            dirty = true;
+        }
+        return true;
+    }
+    dirty = true;
+
+    ArtNode** ref = &root;
+    size_t depth = 0;
+
+    while (true) {
+        ArtNode* node = *ref;
+        if (!node) {
+            *ref = new ArtLeaf(path, status);
+            file_count++;
+            return true;
+        }
+
+        if (node->type == ArtNodeType::LEAF) {
+            ArtLeaf* leaf = static_cast<ArtLeaf*>(node);
+
+            // Two paths meet: a Node4 holds their common bytes as prefix
+            size_t common = 0;
+            while (key_at(leaf->path, depth + common) == key_at(path, depth + common)) {
+                common++;
+            }
+            ArtNode4* split = new ArtNode4();
+            split->prefix_len = static_cast<uint32_t>(common);
+            for (size_t i = 0; i < std::min(common, ART_MAX_PREFIX); ++i) {
+                split->prefix[i] = key_at(path, depth + i);
+            }
+            add_child(ref, split, key_at(leaf->path, depth + common), leaf);
+            add_child(ref, split, key_at(path, depth + common), new ArtLeaf(path, status));
+            split->status_counts[status_slot(leaf->status)]++;
+            split->status_counts[status_slot(status)]++;
+            *ref = split;
+            file_count++;
+            return true;
+        }
+
+        ArtInner* inner = static_cast<ArtInner*>(node);
+        if (inner->prefix_len > 0) {
+            size_t matched = prefix_mismatch(inner, path, depth);
+            if (matched < inner->prefix_len) {
+                // The path leaves the compressed prefix: split it at the
+                // first differing byte
+                ArtNode4* split = new ArtNode4();
+                split->prefix_len = static_cast<uint32_t>(matched);
+                for (size_t i = 0; i < std::min(matched, ART_MAX_PREFIX); ++i) {
+                    split->prefix[i] = key_at(path, depth + i);
+                }
+
+                if (inner->prefix_len <= ART_MAX_PREFIX) {
+                    add_child(ref, split, inner->prefix[matched], inner);
+                    inner->prefix_len -= static_cast<uint32_t>(matched + 1);
+                    std::memmove(inner->prefix, inner->prefix + matched + 1, inner->prefix_len);
+                } else {
+                    const ArtLeaf* leaf = minimum_leaf(inner);
+                    add_child(ref, split, key_at(leaf->path, depth + matched), inner);
+                    inner->prefix_len -= static_cast<uint32_t>(matched + 1);
+                    for (size_t i = 0; i < std::min<size_t>(inner->prefix_len, ART_MAX_PREFIX); ++i) {
+                        inner->prefix[i] = key_at(leaf->path, depth + matched + 1 + i);
+                    }
+                }
+
+                add_child(ref, split, key_at(path, depth + matched), new ArtLeaf(path, status));
+                add_counts(split->status_counts, inner);
+                split->status_counts[status_slot(status)]++;
+                *ref = split;
+                file_count++;
+                return true;
+            }
+            depth += inner->prefix_len;
+        }
+
+        // The new leaf will end up below this node
+        inner->status_counts[status_slot(status)]++;
+
+        ArtNode** child = find_child(inner, key_at(path, depth));
+        if (!child) {
+            add_child(ref, inner, key_at(path, depth), new ArtLeaf(path, status));
+            file_count++;
+            return true;
+        }
+        ref = child;
+        depth++;
+    }
+}
+
+bool Trie::remove(const std::string& path) {
+    ArtLeaf* leaf = find_leaf(root, path);
+    if (!leaf) {
+        return false;
+    }
+
+    size_t slot = status_slot(leaf->status);
+    ArtNode** ref = &root;
+    size_t depth = 0;
+    while (*ref != leaf) {
+        ArtInner* inner = static_cast<ArtInner*>(*ref);
+        inner->status_counts[slot]--;
+        size_t node_depth = depth;
+        depth += inner->prefix_len;
+
+        uint8_t key = key_at(path, depth);
+        ArtNode** child = find_child(inner, key);
+        if (*child == leaf) {
+            remove_child(ref, inner, key, node_depth);
+            break;
+        }
+        ref = child;
+        depth++;
+    }
+    if (root == leaf) {
+        root = nullptr;
+    }
+
+    delete leaf;
+    file_count--;
+    dirty = true;
+    return true;
+}
+
+bool Trie::search(const std::string& path) const {
+    return find_leaf(root, path) != nullptr;
+}
+
+bool Trie::update_status(const std::string& path, FileStatus status) {
+    ArtLeaf* leaf = find_leaf(root, path);
+    if (!leaf) {
+        return false;
+    }
+    if (leaf->status != status) {
+        change_status(root, leaf, status);
+        dirty = true;
+    }
+    return true;
+}
+
+FileStatus Trie::get_status(const std::string& path) const {
+    ArtLeaf* leaf = find_leaf(root, path);
+    return leaf ? leaf->status : FileStatus::UNTRACKED;
+}
+
+bool Trie::visit_files(const std::string& prefix, const FileStatus* status, const FileVisitor& visit) const {
+    // Descend to the subtree holding every path that starts with prefix
+    const ArtNode* node = root;
+    size_t depth = 0;
+    while (node && depth < prefix.size()) {
+        if (node->type == ArtNodeType::LEAF) {
+            const ArtLeaf* leaf = static_cast<const ArtLeaf*>(node);
+            if (leaf->path.compare(0, prefix.size(), prefix) != 0) {
+                return true;
+            }
+            break;
+        }
+
+        const ArtInner* inner = static_cast<const ArtInner*>(node);
+        const ArtLeaf* leaf = nullptr;
+        for (size_t i = 0; i < inner->prefix_len && depth + i < prefix.size(); ++i) {
+            uint8_t expected;
+            if (i < ART_MAX_PREFIX) {
+                expected = inner->prefix[i];
+            } else {
+                if (!leaf) leaf = minimum_leaf(inner);
+                expected = key_at(leaf->path, depth + i);
+            }
+            if (expected != key_at(prefix, depth + i)) {
+                return true;
+            }
+        }
+        depth += inner->prefix_len;
+        if (depth >= prefix.size()) {
+            break;
+        }
+
+        ArtNode** child = find_child(const_cast<ArtInner*>(inner), key_at(prefix, depth));
+        node = child ? *child : nullptr;
+        depth++;
+    }
+    return visit_subtree(node, status, visit);
+}
+
+bool Trie::is_dirty() const {
+    return dirty;
+}
+
+void Trie::clear_dirty() {
+    dirty = false;
+}
+
+bool Trie::for_each_file(const FileVisitor& visit) const {
+    return visit_subtree(root, nullptr, visit);
+}
+
+bool Trie::for_each_file(const std::string& prefix, const FileVisitor& visit) const {
+    return visit_files(prefix, nullptr, visit);
+}
+
+bool Trie::for_each_file_with_status(FileStatus status, const FileVisitor& visit,
+                                     const std::string& prefix) const {
+    return visit_files(prefix, &status, visit);
+}
+
+std::vector<std::string> Trie::get_files_by_status(FileStatus status) const {
+    std::vector<std::string> files;
+    for_each_file_with_status(status, [&files](const std::string& path, FileStatus) {
+        files.push_back(path);
+        return true;
+    });
+    return files;
+}
+
+std::vector<std::pair<std::string, FileStatus>> Trie::get_all_files() const {
+    std::vector<std::pair<std::string, FileStatus>> files;
+    files.reserve(file_count);
+    for_each_file([&files](const std::string& path, FileStatus status) {
+        files.push_back({path, status});
+        return true;
+    });
+    return files;
+}
+
+size_t Trie::size() const {
+    return file_count;
+}
+
+void Trie::draw(WINDOW* win, int start_y, int start_x) const {
+    // Stub implementation - does nothing in non-ncurses mode
+    (void)win;
+    (void)start_y;
+    (void)start_x;
+}
+
+std::string Trie::serialize() const {
+    // Paths come out of the traversal in sorted order, so each one is
+    // front-coded against its predecessor: shared prefix length + suffix
+    BinaryWriter writer;
+    writer.write_header("GGTR");
+    writer.write_u32(static_cast<uint32_t>(file_count));
+
+    const std::string* previous = nullptr;
+    for_each_file([&writer, &previous](const std::string& path, FileStatus status) {
+        size_t shared = 0;
+        if (previous) {
+            size_t limit = std::min(previous->size(), path.size());
+            while (shared < limit && (*previous)[shared] == path[shared]) {
+                shared++;
+            }
+        }
+        writer.write_u8(static_cast<uint8_t>(status));
+        writer.write_u32(static_cast<uint32_t>(shared));
+        writer.write_u32(static_cast<uint32_t>(path.size() - shared));
+        writer.write_bytes(path.data() + shared, path.size() - shared);
+        previous = &path; // Leaf paths stay put for the whole walk
+        return true;
+    });
+    return writer.data();
+}
+
+Trie Trie::deserialize(const std::string& data) {
+    Trie trie;
+    BinaryReader reader(data);
+    if (!reader.read_header("GGTR")) {
+        return trie;
+    }
+
+    uint32_t count = reader.read_u32();
+    std::string path;
+    for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        FileStatus status = static_cast<FileStatus>(reader.read_u8());
+        uint32_t shared = reader.read_u32();
+        uint32_t suffix_length = reader.read_u32();
+        if (shared > path.size()) {
+            break;
+        }
+        path.resize(shared);
+        path += reader.read_bytes(suffix_length);
+        if (reader.ok()) {
+            trie.insert(path, status);
+        }
+    }
+    trie.dirty = false;
+    return trie;
+}
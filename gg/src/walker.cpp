@@ -0,0 +1,186 @@
+/**
+ * walker.cpp - Parallel work-stealing directory walker
+ *
+ * Each directory is read in one pass with readdir(), using the entry type
+ * it reports so that most entries need no extra stat() call. Both filters
+ * are called concurrently from the worker threads, each passing its index.
+ */
+
+#include "../include/walker.h"
+#include <algorithm>
+#include <thread>
+#include <dirent.h>
+#include <sys/stat.h>
+
+static std::string join_path(const std::string& dir, const std::string& name) {
+    return dir == "." ? name : dir + "/" + name;
+}
+
+// ParallelWalker implementation
+ParallelWalker::ParallelWalker(size_t thread_count) : pending(0), queued(0), idle(0) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    this->thread_count = thread_count;
+}
+
+size_t ParallelWalker::get_thread_count() const {
+    return thread_count;
+}
+
+void ParallelWalker::set_directory_filter(PathFilter filter) {
+    skip_directory = filter;
+}
+
+void ParallelWalker::set_file_filter(PathFilter filter) {
+    report_file = filter;
+}
+
+void ParallelWalker::push_directory(size_t worker, const std::string& dir) {
+    pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> guard(queues[worker]->lock);
+        queues[worker]->dirs.push_back(dir);
+    }
+    
+    // A sleeper either sees queued before it waits or gets this notify
+    queued.fetch_add(1);
+    if (idle.load() > 0) {
+        std::lock_guard<std::mutex> guard(idle_lock);
+        work_available.notify_one();
+    }
+}
+
+bool ParallelWalker::pop_directory(size_t worker, std::string& dir) {
+    // Owner works LIFO from the back for locality
+    std::lock_guard<std::mutex> guard(queues[worker]->lock);
+    if (queues[worker]->dirs.empty()) {
+        return false;
+    }
+    dir = std::move(queues[worker]->dirs.back());
+    queues[worker]->dirs.pop_back();
+    queued.fetch_sub(1);
+    return true;
+}
+
+bool ParallelWalker::steal_directory(size_t worker, std::string& dir) {
+    // Thieves take from the front, where the shallowest (largest) subtrees are
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkQueue& victim = *queues[(worker + offset) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.dirs.empty()) {
+            dir = std::move(victim.dirs.front());
+            victim.dirs.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ParallelWalker::scan_directory(size_t worker, const std::string& dir, std::vector<std::string>& found) {
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) {
+        return;
+    }
+    
+    // Read the whole directory first, then queue subdirectories as a batch
+    std::vector<std::string> subdirs;
+    while (struct dirent* entry = readdir(handle)) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+        
+        std::string path = join_path(dir, name);
+        bool is_dir = false;
+        bool is_file = false;
+        
+#ifdef DT_DIR
+        if (entry->d_type == DT_DIR) {
+            is_dir = true;
+        } else if (entry->d_type == DT_REG) {
+            is_file = true;
+        } else
+#endif
+        {
+            // Unknown type or symlink: symlinked directories are not
+            // followed, symlinked files count as files
+            struct stat st;
+            if (lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+                is_dir = true;
+            } else if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+                is_file = true;
+            }
+        }
+        
+        if (is_dir) {
+            if (!skip_directory || !skip_directory(path, worker)) {
+                subdirs.push_back(std::move(path));
+            }
+        } else if (is_file) {
+            if (!report_file || report_file(path, worker)) {
+                found.push_back(std::move(path));
+            }
+        }
+    }
+    closedir(handle);
+    
+    for (const auto& subdir : subdirs) {
+        push_directory(worker, subdir);
+    }
+}
+
+void ParallelWalker::worker_loop(size_t worker, std::vector<std::string>& found) {
+    std::string dir;
+    while (true) {
+        if (pop_directory(worker, dir) || steal_directory(worker, dir)) {
+            scan_directory(worker, dir, found);
+            if (pending.fetch_sub(1) == 1) {
+                // Last directory done: wake the sleepers so they can exit
+                std::lock_guard<std::mutex> guard(idle_lock);
+                work_available.notify_all();
+            }
+            continue;
+        }
+        
+        // Nothing to take: sleep until a directory is queued or the walk ends
+        std::unique_lock<std::mutex> guard(idle_lock);
+        idle.fetch_add(1);
+        work_available.wait(guard, [this] {
+            return pending.load() == 0 || queued.load() > 0;
+        });
+        idle.fetch_sub(1);
+        if (pending.load() == 0) {
+            return;
+        }
+    }
+}
+
+std::vector<std::string> ParallelWalker::walk(const std::string& root) {
+    queues.clear();
+    for (size_t i = 0; i < thread_count; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    pending = 0;
+    queued = 0;
+    push_directory(0, root);
+    
+    // Each worker appends to its own result list; they are merged after join
+    std::vector<std::vector<std::string>> results(thread_count);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(&ParallelWalker::worker_loop, this, i, std::ref(results[i]));
+    }
+    worker_loop(0, results[0]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    std::vector<std::string> files;
+    for (auto& result : results) {
+        files.insert(files.end(), std::make_move_iterator(result.begin()), std::make_move_iterator(result.end()));
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
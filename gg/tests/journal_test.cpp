@@ -0,0 +1,181 @@
+/**
+ * journal_test.cpp - Change journal tests (make test)
+ *
+ * A local stand-in plays the monitor: it writes journal files in the same
+ * format and answers status cookies, so the journal queries, the overflow
+ * fallback and the cookie handshake run without inotify.
+ */
+
+#include "../include/monitor.h"
+#include "../include/serial.h"
+#include "../include/gg.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+// Journal contents as the monitor writes them
+static std::string journal_data(uint64_t epoch, const std::vector<std::string>& paths) {
+    BinaryWriter writer;
+    writer.write_header("GGJR");
+    writer.write_u64(epoch);
+    uint64_t token = 1;
+    for (const auto& path : paths) {
+        writer.write_u64(token++);
+        writer.write_string(path);
+    }
+    return writer.data();
+}
+
+static void append_record(uint64_t token, const std::string& path) {
+    BinaryWriter writer;
+    writer.write_u64(token);
+    writer.write_string(path);
+    std::ofstream file(MONITOR_JOURNAL_FILE, std::ios::binary | std::ios::app);
+    file << writer.data();
+}
+
+static void test_changes_since() {
+    write_file_contents(MONITOR_JOURNAL_FILE, journal_data(7, {"a.txt", "src/b.c", "a.txt"}));
+
+    ChangeJournal journal;
+    CHECK(journal.load());
+    CHECK(journal.get_epoch() == 7);
+    CHECK(journal.get_latest_token() == 3);
+
+    std::set<std::string> paths;
+    CHECK(journal.changes_since(7, 0, paths));
+    CHECK(paths == std::set<std::string>({"a.txt", "src/b.c"}));
+
+    paths.clear();
+    CHECK(journal.changes_since(7, 2, paths));
+    CHECK(paths == std::set<std::string>({"a.txt"}));
+
+    paths.clear();
+    CHECK(journal.changes_since(7, 3, paths));
+    CHECK(paths.empty());
+
+    // A position the journal has not reached yet cannot be vouched for
+    CHECK(!journal.changes_since(7, 4, paths));
+}
+
+// The monitor resets the journal under a new epoch when it overflows or
+// loses events; positions from the old epoch must force a full scan
+static void test_overflow_fallback() {
+    write_file_contents(MONITOR_JOURNAL_FILE, journal_data(7, {"a.txt"}));
+    ChangeJournal journal;
+    CHECK(journal.load());
+    uint64_t token = journal.get_latest_token();
+
+    write_file_contents(MONITOR_JOURNAL_FILE, journal_data(8, {"c.txt"}));
+    CHECK(journal.load());
+
+    std::set<std::string> paths;
+    CHECK(!journal.changes_since(7, token, paths));
+    CHECK(journal.changes_since(8, 0, paths));
+    CHECK(paths == std::set<std::string>({"c.txt"}));
+
+    // A stopped monitor removes its journal
+    fs::remove(MONITOR_JOURNAL_FILE);
+    CHECK(!journal.load());
+}
+
+// A record cut short by an in-progress append is not read
+static void test_truncated_record() {
+    std::string data = journal_data(9, {"a.txt", "long/path/name.txt"});
+    write_file_contents(MONITOR_JOURNAL_FILE, data.substr(0, data.size() - 3));
+
+    ChangeJournal journal;
+    CHECK(journal.load());
+    CHECK(journal.get_latest_token() == 1);
+
+    std::set<std::string> paths;
+    CHECK(journal.changes_since(9, 0, paths));
+    CHECK(paths == std::set<std::string>({"a.txt"}));
+}
+
+static bool is_cookie(const fs::path& path) {
+    return path.filename().string().rfind(MONITOR_COOKIE_PREFIX, 0) == 0;
+}
+
+// Stand-in monitor: journals status cookies as they appear
+static void answer_cookies(std::atomic<bool>& stop, uint64_t first_token) {
+    uint64_t token = first_token;
+    std::set<std::string> seen;
+    while (!stop) {
+        for (const auto& entry : fs::directory_iterator(MONITOR_DIR)) {
+            std::string path = std::string(MONITOR_DIR) + "/" + entry.path().filename().string();
+            if (is_cookie(entry.path()) && seen.insert(path).second) {
+                append_record(token++, path);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static void test_sync_with_monitor() {
+    write_file_contents(MONITOR_JOURNAL_FILE, journal_data(10, {"a.txt"}));
+
+    std::atomic<bool> stop(false);
+    std::thread monitor(answer_cookies, std::ref(stop), 2);
+    ChangeJournal journal;
+    CHECK(sync_with_monitor(journal, 2000));
+    stop = true;
+    monitor.join();
+
+    // The journal includes the cookie, and the cookie is cleaned up
+    CHECK(journal.get_latest_token() == 2);
+    bool cookie_left = false;
+    for (const auto& entry : fs::directory_iterator(MONITOR_DIR)) {
+        cookie_left |= is_cookie(entry.path());
+    }
+    CHECK(!cookie_left);
+
+    // Nobody journals the cookie: give up so status does a full scan
+    auto start = std::chrono::steady_clock::now();
+    CHECK(!sync_with_monitor(journal, 50));
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+}
+
+int main() {
+    char dir_template[] = "/tmp/gg-journal-test-XXXXXX";
+    if (!mkdtemp(dir_template) || chdir(dir_template) != 0) {
+        std::perror("journal_test");
+        return 1;
+    }
+    fs::create_directories(MONITOR_DIR);
+
+    test_changes_since();
+    test_overflow_fallback();
+    test_truncated_record();
+    test_sync_with_monitor();
+
+    fs::current_path("/");
+    fs::remove_all(dir_template);
+
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("journal_test: all checks passed\n");
+    return 0;
+}